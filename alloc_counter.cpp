@@ -0,0 +1,106 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Свой счётчик у каждого потока: operator new замещён во всей программе,
+// и общий атомик заставил бы потоки batch/generate/store толкаться на одной
+// кэш-линии при каждом выделении. thread_local без конструктора не требует
+// динамической инициализации, поэтому безопасен внутри operator new.
+thread_local std::uint64_t t_allocations = 0;
+
+void* AllocateAligned(std::size_t size, std::size_t alignment) {
+#if defined(_WIN32)
+  return _aligned_malloc(size, alignment);
+#else
+  // aligned_alloc требует размер, кратный выравниванию.
+  return std::aligned_alloc(alignment,
+                            (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void FreeAligned(void* p) {
+#if defined(_WIN32)
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+}  // namespace
+
+namespace sudoku {
+
+std::uint64_t AllocationCount() { return t_allocations; }
+
+}  // namespace sudoku
+
+void* operator new(std::size_t size) {
+  ++t_allocations;
+  if (size == 0) size = 1;
+  while (true) {
+    if (void* p = std::malloc(size)) return p;
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  ++t_allocations;
+  if (size == 0) size = 1;
+  while (true) {
+    if (void* p = AllocateAligned(size, static_cast<std::size_t>(alignment))) {
+      return p;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+  FreeAligned(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  FreeAligned(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  FreeAligned(p);
+}
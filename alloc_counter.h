@@ -0,0 +1,19 @@
+#ifndef SUDOKU_ALLOC_COUNTER_H_
+#define SUDOKU_ALLOC_COUNTER_H_
+
+#include <cstdint>
+
+namespace sudoku {
+
+// Сколько раз вызывающий поток с начала своей работы вызывал глобальный
+// operator new (обычный, new[] и варианты с std::align_val_t; nothrow-
+// варианты стандартной библиотеки идут через них же). Счётчик ведёт замена
+// operator new/delete в alloc_counter.cpp; нужен бенчмаркам и
+// tests/alloc_test.cpp, чтобы считать выделения памяти на операцию.
+// Выделения других потоков (например, рабочих потоков SolveParallel) сюда
+// не попадают.
+std::uint64_t AllocationCount();
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_ALLOC_COUNTER_H_
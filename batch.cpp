@@ -0,0 +1,647 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "batch_validator.h"
+#include "corpus.h"
+#include "grid_enumerator.h"
+#include "grid_parser.h"
+#include "parallel.h"
+#include "propagation.h"
+#include "puzzle_store.h"
+#include "solution_cache.h"
+
+namespace sudoku {
+namespace {
+
+bool SolvePropagated(SudokuGrid* grid, SolveStats* stats) {
+  return SolveWithPropagation(grid, nullptr, stats);
+}
+
+void AddToHistograms(const SolveStats& stats, SolveHistograms* histograms) {
+  histograms->nanoseconds.Add(
+      static_cast<std::uint64_t>(stats.seconds * 1e9 + 0.5));
+  histograms->nodes.Add(static_cast<std::uint64_t>(stats.nodes));
+  histograms->backtracks.Add(static_cast<std::uint64_t>(stats.backtracks));
+  histograms->max_depth.Add(static_cast<std::uint64_t>(stats.max_depth));
+
+  SolveStats& total = histograms->total;
+  total.nodes += stats.nodes;
+  total.backtracks += stats.backtracks;
+  total.propagation_hits += stats.propagation_hits;
+  if (stats.max_depth > total.max_depth) total.max_depth = stats.max_depth;
+  total.seconds += stats.seconds;
+}
+
+void PrintHistogram(const char* title, const Log2Histogram& histogram,
+                    std::ostream* out) {
+  *out << title << ":\n";
+  for (std::size_t k = 0; k < histogram.buckets.size(); ++k) {
+    if (histogram.buckets[k] == 0) continue;
+    if (k == 0) {
+      *out << "  0";
+    } else {
+      *out << "  [" << (1ull << (k - 1)) << ", ";
+      if (k < 64) {
+        *out << (1ull << k) << ")";
+      } else {
+        *out << "2^64)";
+      }
+    }
+    *out << ": " << histogram.buckets[k] << "\n";
+  }
+}
+
+// Читает до max_count задач. Возвращает false только при ошибке формата.
+bool ReadChunk(GridParser* parser, std::size_t max_count,
+               std::vector<SudokuGrid>* puzzles, std::string* error) {
+  puzzles->clear();
+  SudokuGrid grid;
+  while (puzzles->size() < max_count && parser->Next(&grid)) {
+    puzzles->push_back(grid);
+  }
+  if (!parser->ok()) {
+    if (error) *error = parser->error();
+    return false;
+  }
+  return true;
+}
+
+// Порции записей корпуса подряд — источник для SolveChunks и StoreChunks.
+class CorpusChunks {
+ public:
+  CorpusChunks(const CorpusReader* corpus, std::string* error)
+      : corpus_(corpus), error_(error) {}
+
+  bool operator()(std::size_t max_count, std::vector<SudokuGrid>* grids) {
+    const std::size_t n = std::min(max_count, corpus_->size() - next_);
+    grids->resize(n);
+    for (std::size_t i = 0; i < n; ++i, ++next_) {
+      if (!corpus_->Get(next_, &(*grids)[i])) {
+        if (error_) {
+          *error_ = "запись " + std::to_string(next_) + " повреждена";
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  const CorpusReader* corpus_;
+  std::string* error_;
+  std::size_t next_ = 0;
+};
+
+bool WriteGrids(const std::vector<SudokuGrid>& grids, std::string* buffer,
+                std::ostream* out, std::string* error) {
+  buffer->clear();
+  buffer->reserve(grids.size() * (SudokuGrid::kCellCount + 1));
+  for (const SudokuGrid& grid : grids) {
+    *buffer += grid.ToCompactString();
+    buffer->push_back('\n');
+  }
+  out->write(buffer->data(), static_cast<std::streamsize>(buffer->size()));
+  if (!out->good()) {
+    if (error) *error = "ошибка записи результата";
+    return false;
+  }
+  return true;
+}
+
+bool OpenOutput(const std::string& path, std::ofstream* fout,
+                std::ostream** out, std::string* error) {
+  *out = &std::cout;
+  if (path == "-") return true;
+
+  fout->open(path);
+  if (!fout->is_open()) {
+    if (error) *error = "не удалось открыть файл на запись";
+    return false;
+  }
+  *out = fout;
+  return true;
+}
+
+// Общий цикл пакетного решения: next_chunk(max_count, grids) заполняет
+// очередную порцию (пустая — конец входа) и возвращает false при ошибке.
+template <typename NextChunk>
+bool SolveChunks(NextChunk next_chunk, std::ostream* out,
+                 const BatchSolveOptions& options, BatchSolveStats* stats,
+                 std::string* error) {
+  const SolveFunction solve =
+      options.solve != nullptr ? options.solve : &SolvePropagated;
+  const std::size_t chunk_size =
+      options.chunk_size == 0 ? 1 : options.chunk_size;
+
+  BatchSolveStats local;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<SudokuGrid> grids;
+  std::vector<char> solved;
+  std::vector<SolveStats> puzzle_stats;
+  std::string buffer;
+
+  while (true) {
+    if (!next_chunk(chunk_size, &grids)) return false;
+    if (grids.empty()) break;
+
+    solved.assign(grids.size(), 0);
+    if (options.collect_stats) puzzle_stats.assign(grids.size(), SolveStats());
+    ParallelFor(grids.size(), options.thread_count, [&](std::size_t i) {
+      SudokuGrid work = grids[i];
+      SolveStats* s = options.collect_stats ? &puzzle_stats[i] : nullptr;
+      const bool ok = options.cache != nullptr
+                          ? options.cache->Solve(&work, solve, s)
+                          : solve(&work, s);
+      if (ok) {
+        grids[i] = work;
+        solved[i] = 1;
+      }
+    });
+
+    if (!WriteGrids(grids, &buffer, out, error)) return false;
+    for (char ok : solved) local.solved += ok;
+    // Сводится в одном потоке после порции: без атомиков и блокировок.
+    if (options.collect_stats) {
+      for (const SolveStats& s : puzzle_stats) {
+        AddToHistograms(s, &local.histograms);
+      }
+    }
+    local.puzzles += grids.size();
+  }
+
+  out->flush();
+  local.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  if (stats) *stats = local;
+  if (error) *error = "";
+  return true;
+}
+
+// Проверка порциями сырых полей: next_cells(max_count, cells) заполняет
+// очередную порцию блоками по 81 байту (пустая — конец входа). Вся порция
+// идёт в ValidateCellBlocks, причина (DescribeCellBlock) ищется только для
+// некорректных полей. Строка вывода — поле в компактном формате и " ok"
+// либо " invalid <причина>".
+template <typename NextCells>
+bool ValidateChunks(NextCells next_cells, std::size_t chunk_size,
+                    std::ostream* out, BatchSolveStats* stats,
+                    std::string* error) {
+  if (chunk_size == 0) chunk_size = 1;
+
+  BatchSolveStats local;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::uint8_t> cells;
+  std::vector<std::uint8_t> results;
+  std::string buffer;
+  std::string reason;
+
+  while (true) {
+    if (!next_cells(chunk_size, &cells)) return false;
+    const std::size_t count = cells.size() / SudokuGrid::kCellCount;
+    if (count == 0) break;
+
+    results.resize(count);
+    ValidateCellBlocks(cells.data(), count, results.data());
+
+    buffer.clear();
+    for (std::size_t g = 0; g < count; ++g) {
+      const std::uint8_t* grid = cells.data() + g * SudokuGrid::kCellCount;
+      for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+        buffer.push_back(ValueToChar(grid[i]));
+      }
+      if (results[g] == kValidationOk) {
+        buffer += " ok\n";
+        ++local.solved;
+        continue;
+      }
+      DescribeCellBlock(grid, &reason);
+      buffer += " invalid ";
+      buffer += reason;
+      buffer.push_back('\n');
+    }
+    out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!out->good()) {
+      if (error) *error = "ошибка записи результата";
+      return false;
+    }
+    local.puzzles += count;
+  }
+
+  out->flush();
+  local.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  if (stats) *stats = local;
+  if (error) *error = "";
+  return true;
+}
+
+// Добавление в хранилище порциями (см. StoreBatch).
+template <typename NextChunk>
+bool StoreChunks(NextChunk next_chunk, PuzzleStore* store, std::ostream* out,
+                 const StoreBatchOptions& options, StoreBatchStats* stats,
+                 std::string* error) {
+  if (store == nullptr) {
+    if (error) *error = "внутренняя ошибка: store == nullptr";
+    return false;
+  }
+  const std::size_t chunk_size =
+      options.chunk_size == 0 ? 1 : options.chunk_size;
+  enum : std::uint8_t { kNew, kSeen, kBad };
+
+  StoreBatchStats local;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<SudokuGrid> grids;
+  std::vector<PuzzleStore::Key> keys;
+  std::vector<SudokuGrid> solutions;
+  std::vector<std::uint8_t> status;
+  std::vector<SudokuGrid> fresh;
+  std::string buffer;
+
+  while (true) {
+    if (!next_chunk(chunk_size, &grids)) return false;
+    if (grids.empty()) break;
+
+    keys.resize(grids.size());
+    status.assign(grids.size(), kNew);
+    ParallelFor(grids.size(), options.thread_count, [&](std::size_t i) {
+      if (grids[i].HasConflicts()) {
+        status[i] = kBad;
+        return;
+      }
+      keys[i] = store->KeyOf(grids[i]);
+    });
+    // Повторы отсеиваются до решения: решаются только новые задачи.
+    for (std::size_t i = 0; i < grids.size(); ++i) {
+      if (status[i] == kNew && store->Find(keys[i], nullptr)) status[i] = kSeen;
+    }
+    if (options.solve) {
+      solutions.resize(grids.size());
+      ParallelFor(grids.size(), options.thread_count, [&](std::size_t i) {
+        if (status[i] != kNew) return;
+        solutions[i] = grids[i];
+        if (!SolveWithPropagation(&solutions[i], nullptr)) status[i] = kBad;
+      });
+    }
+
+    fresh.clear();
+    for (std::size_t i = 0; i < grids.size(); ++i) {
+      if (status[i] == kBad) {
+        ++local.invalid;
+        continue;
+      }
+      if (status[i] == kSeen) {
+        ++local.duplicates;
+        continue;
+      }
+      if (options.check_only) {
+        ++local.added;
+        fresh.push_back(grids[i]);
+        continue;
+      }
+      switch (store->Insert(keys[i], grids[i],
+                            options.solve ? &solutions[i] : nullptr)) {
+        case StoreInsert::kAdded:
+          ++local.added;
+          fresh.push_back(grids[i]);
+          break;
+        case StoreInsert::kDuplicate:  // Повтор раньше в том же входе.
+          ++local.duplicates;
+          break;
+        case StoreInsert::kInvalid:
+          ++local.invalid;
+          break;
+        case StoreInsert::kIoError:
+          if (error) *error = "ошибка записи в хранилище";
+          return false;
+      }
+    }
+
+    if (out != nullptr && !WriteGrids(fresh, &buffer, out, error)) {
+      return false;
+    }
+    local.puzzles += grids.size();
+  }
+
+  if (out != nullptr) out->flush();
+  local.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  if (stats) *stats = local;
+  if (error) *error = "";
+  return true;
+}
+
+}  // namespace
+
+void Log2Histogram::Add(std::uint64_t value) {
+  std::size_t k = 0;
+  while (value != 0) {
+    ++k;
+    value >>= 1;
+  }
+  ++buckets[k];
+}
+
+void PrintSolveHistograms(const SolveHistograms& histograms,
+                          std::ostream* out) {
+  if (out == nullptr) return;
+
+  const SolveStats& total = histograms.total;
+  *out << "Итого: узлов " << total.nodes << ", откатов " << total.backtracks
+       << ", вынужденных ходов " << total.propagation_hits
+       << ", макс. глубина " << total.max_depth << ", время решения "
+       << total.seconds << " с\n";
+  PrintHistogram("время на задачу, нс", histograms.nanoseconds, out);
+  PrintHistogram("узлы перебора", histograms.nodes, out);
+  PrintHistogram("откаты", histograms.backtracks, out);
+  PrintHistogram("макс. глубина", histograms.max_depth, out);
+}
+
+bool SolveBatch(std::istream* in, std::ostream* out,
+                const BatchSolveOptions& options, BatchSolveStats* stats,
+                std::string* error) {
+  if (in == nullptr || out == nullptr) {
+    if (error) *error = "внутренняя ошибка: поток == nullptr";
+    return false;
+  }
+
+  GridParser parser(in);
+  return SolveChunks(
+      [&](std::size_t max_count, std::vector<SudokuGrid>* grids) {
+        return ReadChunk(&parser, max_count, grids, error);
+      },
+      out, options, stats, error);
+}
+
+bool SolveBatch(const CorpusReader& corpus, std::ostream* out,
+                const BatchSolveOptions& options, BatchSolveStats* stats,
+                std::string* error) {
+  if (out == nullptr) {
+    if (error) *error = "внутренняя ошибка: поток == nullptr";
+    return false;
+  }
+
+  return SolveChunks(CorpusChunks(&corpus, error), out, options, stats,
+                     error);
+}
+
+bool SolveBatchFile(const std::string& input_path,
+                    const std::string& output_path,
+                    const BatchSolveOptions& options, BatchSolveStats* stats,
+                    std::string* error) {
+  if (input_path != "-" && IsCorpusFile(input_path)) {
+    CorpusReader corpus;
+    if (!corpus.Open(input_path, error)) return false;
+
+    std::ofstream fout;
+    std::ostream* out = nullptr;
+    if (!OpenOutput(output_path, &fout, &out, error)) return false;
+    return SolveBatch(corpus, out, options, stats, error);
+  }
+
+  std::ifstream fin;
+  std::istream* in = &std::cin;
+  if (input_path != "-") {
+    fin.open(input_path, std::ios::binary);
+    if (!fin.is_open()) {
+      if (error) *error = "не удалось открыть входной файл";
+      return false;
+    }
+    in = &fin;
+  }
+
+  std::ofstream fout;
+  std::ostream* out = nullptr;
+  if (!OpenOutput(output_path, &fout, &out, error)) return false;
+
+  return SolveBatch(in, out, options, stats, error);
+}
+
+bool GenerateBatch(const BulkGenerateOptions& options, std::uint64_t count,
+                   std::size_t chunk_size, std::ostream* out,
+                   BatchSolveStats* stats, std::string* error) {
+  if (out == nullptr) {
+    if (error) *error = "внутренняя ошибка: поток == nullptr";
+    return false;
+  }
+  if (chunk_size == 0) chunk_size = 1;
+
+  BatchSolveStats local;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<SudokuGrid> grids;
+  std::string buffer;
+  for (std::uint64_t first = 0; first < count; first += chunk_size) {
+    const std::size_t n = static_cast<std::size_t>(
+        std::min<std::uint64_t>(chunk_size, count - first));
+    GeneratePuzzles(options, first, n, &grids);
+    if (!WriteGrids(grids, &buffer, out, error)) return false;
+    local.puzzles += n;
+  }
+
+  out->flush();
+  local.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  if (stats) *stats = local;
+  if (error) *error = "";
+  return true;
+}
+
+bool GenerateBatchFile(const BulkGenerateOptions& options, std::uint64_t count,
+                       const std::string& output_path, BatchSolveStats* stats,
+                       std::string* error) {
+  std::ofstream fout;
+  std::ostream* out = nullptr;
+  if (!OpenOutput(output_path, &fout, &out, error)) return false;
+
+  constexpr std::size_t kGenerateChunk = 1 << 12;
+  return GenerateBatch(options, count, kGenerateChunk, out, stats, error);
+}
+
+bool EnumerateBatch(const SudokuGrid& start, std::uint64_t count,
+                    std::size_t chunk_size, std::ostream* out,
+                    BatchSolveStats* stats, std::string* error) {
+  if (out == nullptr) {
+    if (error) *error = "внутренняя ошибка: поток == nullptr";
+    return false;
+  }
+  if (chunk_size == 0) chunk_size = 1;
+
+  BatchSolveStats local;
+  const auto start_time = std::chrono::steady_clock::now();
+
+  SolvedGridEnumerator enumerator(start);
+  std::vector<SudokuGrid> grids;
+  grids.reserve(chunk_size);
+  std::string buffer;
+  SudokuGrid grid;
+  bool more = true;
+  while (more) {
+    grids.clear();
+    while (grids.size() < chunk_size &&
+           (count == 0 || enumerator.count() < count)) {
+      more = enumerator.Next(&grid);
+      if (!more) break;
+      grids.push_back(grid);
+    }
+    if (count != 0 && enumerator.count() >= count) more = false;
+    if (!WriteGrids(grids, &buffer, out, error)) return false;
+    local.puzzles += grids.size();
+  }
+
+  out->flush();
+  local.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start_time)
+                      .count();
+  if (stats) *stats = local;
+  if (error) *error = "";
+  return true;
+}
+
+bool EnumerateBatchFile(const SudokuGrid& start, std::uint64_t count,
+                        const std::string& output_path, BatchSolveStats* stats,
+                        std::string* error) {
+  std::ofstream fout;
+  std::ostream* out = nullptr;
+  if (!OpenOutput(output_path, &fout, &out, error)) return false;
+
+  constexpr std::size_t kEnumerateChunk = 1 << 12;
+  return EnumerateBatch(start, count, kEnumerateChunk, out, stats, error);
+}
+
+bool ValidateBatch(std::istream* in, std::ostream* out, std::size_t chunk_size,
+                   BatchSolveStats* stats, std::string* error) {
+  if (in == nullptr || out == nullptr) {
+    if (error) *error = "внутренняя ошибка: поток == nullptr";
+    return false;
+  }
+
+  GridParser parser(in);
+  return ValidateChunks(
+      [&](std::size_t max_count, std::vector<std::uint8_t>* cells) {
+        cells->resize(max_count * SudokuGrid::kCellCount);
+        std::size_t n = 0;
+        while (n < max_count &&
+               parser.NextCells(cells->data() + n * SudokuGrid::kCellCount)) {
+          ++n;
+        }
+        cells->resize(n * SudokuGrid::kCellCount);
+        if (!parser.ok()) {
+          if (error) *error = parser.error();
+          return false;
+        }
+        return true;
+      },
+      chunk_size, out, stats, error);
+}
+
+bool ValidateBatchFile(const std::string& input_path,
+                       const std::string& output_path, BatchSolveStats* stats,
+                       std::string* error) {
+  constexpr std::size_t kValidateChunk = 1 << 16;
+  std::ofstream fout;
+  std::ostream* out = nullptr;
+
+  if (input_path != "-" && IsCorpusFile(input_path)) {
+    CorpusReader corpus;
+    if (!corpus.Open(input_path, error)) return false;
+    if (!OpenOutput(output_path, &fout, &out, error)) return false;
+    // Записи распаковываются без проверки: тетрады больше 9 — не ошибка
+    // чтения, а строка "invalid" с причиной.
+    std::size_t next = 0;
+    return ValidateChunks(
+        [&](std::size_t max_count, std::vector<std::uint8_t>* cells) {
+          const std::size_t n = std::min(max_count, corpus.size() - next);
+          cells->resize(n * SudokuGrid::kCellCount);
+          for (std::size_t i = 0; i < n; ++i, ++next) {
+            UnpackCells(corpus.Record(next),
+                        cells->data() + i * SudokuGrid::kCellCount);
+          }
+          return true;
+        },
+        kValidateChunk, out, stats, error);
+  }
+
+  std::ifstream fin;
+  std::istream* in = &std::cin;
+  if (input_path != "-") {
+    fin.open(input_path, std::ios::binary);
+    if (!fin.is_open()) {
+      if (error) *error = "не удалось открыть входной файл";
+      return false;
+    }
+    in = &fin;
+  }
+  if (!OpenOutput(output_path, &fout, &out, error)) return false;
+  return ValidateBatch(in, out, kValidateChunk, stats, error);
+}
+
+bool StoreBatch(std::istream* in, PuzzleStore* store, std::ostream* out,
+                const StoreBatchOptions& options, StoreBatchStats* stats,
+                std::string* error) {
+  if (in == nullptr) {
+    if (error) *error = "внутренняя ошибка: поток == nullptr";
+    return false;
+  }
+
+  GridParser parser(in);
+  return StoreChunks(
+      [&](std::size_t max_count, std::vector<SudokuGrid>* grids) {
+        return ReadChunk(&parser, max_count, grids, error);
+      },
+      store, out, options, stats, error);
+}
+
+bool StoreBatch(const CorpusReader& corpus, PuzzleStore* store,
+                std::ostream* out, const StoreBatchOptions& options,
+                StoreBatchStats* stats, std::string* error) {
+  return StoreChunks(CorpusChunks(&corpus, error), store, out, options, stats,
+                     error);
+}
+
+bool StoreBatchFile(const std::string& input_path,
+                    const std::string& output_path, PuzzleStore* store,
+                    const StoreBatchOptions& options, StoreBatchStats* stats,
+                    std::string* error) {
+  std::ofstream fout;
+  std::ostream* out = nullptr;
+
+  if (input_path != "-" && IsCorpusFile(input_path)) {
+    CorpusReader corpus;
+    if (!corpus.Open(input_path, error)) return false;
+    if (!output_path.empty() &&
+        !OpenOutput(output_path, &fout, &out, error)) {
+      return false;
+    }
+    return StoreBatch(corpus, store, out, options, stats, error);
+  }
+
+  std::ifstream fin;
+  std::istream* in = &std::cin;
+  if (input_path != "-") {
+    fin.open(input_path, std::ios::binary);
+    if (!fin.is_open()) {
+      if (error) *error = "не удалось открыть входной файл";
+      return false;
+    }
+    in = &fin;
+  }
+  if (!output_path.empty() && !OpenOutput(output_path, &fout, &out, error)) {
+    return false;
+  }
+  return StoreBatch(in, store, out, options, stats, error);
+}
+
+}  // namespace sudoku
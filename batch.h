@@ -0,0 +1,149 @@
+#ifndef SUDOKU_BATCH_H_
+#define SUDOKU_BATCH_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "corpus.h"
+#include "generator.h"
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+class PuzzleStore;
+class SolutionCache;
+
+// stats может быть nullptr (тогда счётчики и время не собираются).
+using SolveFunction = bool (*)(SudokuGrid* grid, SolveStats* stats);
+
+struct BatchSolveOptions {
+  int thread_count = 0;               // 0 — по числу ядер.
+  std::size_t chunk_size = 1 << 16;   // Сколько задач читается за один шаг.
+  SolveFunction solve = nullptr;      // nullptr — SolveWithPropagation.
+  bool collect_stats = false;         // Заполнять BatchSolveStats::histograms.
+  SolutionCache* cache = nullptr;     // Не nullptr — решать через кэш.
+};
+
+// Гистограмма по степеням двойки: корзина 0 — значение 0, корзина k —
+// значения из [2^(k-1), 2^k).
+struct Log2Histogram {
+  std::array<std::uint64_t, 65> buckets{};
+
+  void Add(std::uint64_t value);
+};
+
+// Распределения счётчиков SolveStats по задачам пакета.
+struct SolveHistograms {
+  Log2Histogram nanoseconds;
+  Log2Histogram nodes;
+  Log2Histogram backtracks;
+  Log2Histogram max_depth;
+  SolveStats total;  // Сумма по задачам (max_depth — максимум).
+};
+
+struct BatchSolveStats {
+  std::size_t puzzles = 0;
+  std::size_t solved = 0;  // При проверке — корректные поля.
+  double seconds = 0.0;
+  SolveHistograms histograms;  // Только при collect_stats.
+};
+
+// Пакетное решение: вход — задачи в любом формате GridParser (обычно по
+// одной в компактном формате на строку). Задачи читаются порциями по
+// chunk_size, решаются параллельно и выводятся в исходном порядке. Для
+// нерешаемой задачи выводится сама задача без изменений.
+bool SolveBatch(std::istream* in, std::ostream* out,
+                const BatchSolveOptions& options, BatchSolveStats* stats,
+                std::string* error);
+
+// То же для двоичного корпуса (corpus.h): задачи читаются из отображённого
+// в память файла без разбора текста.
+bool SolveBatch(const CorpusReader& corpus, std::ostream* out,
+                const BatchSolveOptions& options, BatchSolveStats* stats,
+                std::string* error);
+
+// То же для файлов; путь "-" означает stdin/stdout. Входной файл может быть
+// и текстовым, и двоичным корпусом — формат определяется по сигнатуре.
+bool SolveBatchFile(const std::string& input_path,
+                    const std::string& output_path,
+                    const BatchSolveOptions& options, BatchSolveStats* stats,
+                    std::string* error);
+
+// Массовая генерация count задач (GeneratePuzzles) порциями по chunk_size
+// с выводом в компактном формате, по одной задаче на строку.
+bool GenerateBatch(const BulkGenerateOptions& options, std::uint64_t count,
+                   std::size_t chunk_size, std::ostream* out,
+                   BatchSolveStats* stats, std::string* error);
+
+bool GenerateBatchFile(const BulkGenerateOptions& options, std::uint64_t count,
+                       const std::string& output_path, BatchSolveStats* stats,
+                       std::string* error);
+
+// Потоковый вывод решений start (SolvedGridEnumerator) в компактном формате
+// порциями по chunk_size; count == 0 — все решения.
+bool EnumerateBatch(const SudokuGrid& start, std::uint64_t count,
+                    std::size_t chunk_size, std::ostream* out,
+                    BatchSolveStats* stats, std::string* error);
+
+bool EnumerateBatchFile(const SudokuGrid& start, std::uint64_t count,
+                        const std::string& output_path, BatchSolveStats* stats,
+                        std::string* error);
+
+// Пакетная проверка корректности (batch_validator.h) порциями по
+// chunk_size: на каждое поле строка "<поле> ok" или "<поле> invalid
+// <причина>" в исходном порядке; stats->solved — число корректных полей.
+bool ValidateBatch(std::istream* in, std::ostream* out, std::size_t chunk_size,
+                   BatchSolveStats* stats, std::string* error);
+
+// То же для файлов ("-" — stdin/stdout); вход — текст или корпус.
+bool ValidateBatchFile(const std::string& input_path,
+                       const std::string& output_path, BatchSolveStats* stats,
+                       std::string* error);
+
+struct StoreBatchOptions {
+  int thread_count = 0;              // 0 — по числу ядер.
+  std::size_t chunk_size = 1 << 16;  // Сколько задач читается за один шаг.
+  bool solve = false;       // Записывать решения (SolveWithPropagation);
+                            // нерешаемые задачи не добавляются.
+  bool check_only = false;  // Только сверять с хранилищем, не добавляя.
+};
+
+struct StoreBatchStats {
+  std::size_t puzzles = 0;
+  std::size_t added = 0;       // При check_only — не найденные в хранилище.
+  std::size_t duplicates = 0;  // Уже были в хранилище или раньше во входе.
+  std::size_t invalid = 0;     // С повторами или (при solve) нерешаемые.
+  double seconds = 0.0;
+};
+
+// Пакетное добавление в хранилище (puzzle_store.h) без повторов: ключи и
+// решения порции считаются параллельно, поиск и запись идут в одном
+// потоке; решаются только задачи, которых ещё нет. В out (может быть
+// nullptr) выводятся новые задачи в компактном формате в исходном порядке.
+// При check_only повторы внутри самого входа не ищутся.
+bool StoreBatch(std::istream* in, PuzzleStore* store, std::ostream* out,
+                const StoreBatchOptions& options, StoreBatchStats* stats,
+                std::string* error);
+
+bool StoreBatch(const CorpusReader& corpus, PuzzleStore* store,
+                std::ostream* out, const StoreBatchOptions& options,
+                StoreBatchStats* stats, std::string* error);
+
+// То же для файлов: вход — текст или корпус ("-" — stdin), пустой
+// output_path — новые задачи не выводятся.
+bool StoreBatchFile(const std::string& input_path,
+                    const std::string& output_path, PuzzleStore* store,
+                    const StoreBatchOptions& options, StoreBatchStats* stats,
+                    std::string* error);
+
+// Текстовый отчёт по гистограммам: итоги и непустые корзины.
+void PrintSolveHistograms(const SolveHistograms& histograms,
+                          std::ostream* out);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_BATCH_H_
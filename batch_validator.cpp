@@ -0,0 +1,147 @@
+#include "batch_validator.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUDOKU_HAVE_SSSE3_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace sudoku {
+namespace {
+
+constexpr int kLanes = 16;
+
+std::uint8_t UnitKindFlag(int unit) {
+  if (unit < SudokuGrid::kSize) return kRowConflict;
+  if (unit < 2 * SudokuGrid::kSize) return kColConflict;
+  return kBoxConflict;
+}
+
+std::uint8_t ValidateOne(const std::uint8_t* cells) {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (cells[i] > SudokuGrid::kSize) return kValueOutOfRange;
+  }
+
+  const UnitCellTable& units = UnitCells();
+  std::uint8_t flags = kValidationOk;
+  for (int u = 0; u < kUnitCount; ++u) {
+    unsigned seen = 0;
+    unsigned dup = 0;
+    for (int i : units[u]) {
+      const unsigned bit = (1u << cells[i]) & SudokuGrid::kAllDigits;
+      dup |= seen & bit;
+      seen |= bit;
+    }
+    if (dup != 0) flags |= UnitKindFlag(u);
+  }
+  return flags;
+}
+
+#ifdef SUDOKU_HAVE_SSSE3_KERNEL
+
+// 16 полей: дорожка g вектора — поле g. Цифры 1..8 кодируются битом в
+// младшем векторе, 9 — в старшем; повтор в группе — пересечение бита
+// клетки с накопленными битами группы.
+__attribute__((target("ssse3"))) void ValidateLanesSsse3(
+    const std::uint8_t* cells, std::uint8_t* results) {
+  alignas(16) std::uint8_t lanes[SudokuGrid::kCellCount][kLanes];
+  for (int g = 0; g < kLanes; ++g) {
+    const std::uint8_t* grid = cells + g * SudokuGrid::kCellCount;
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) lanes[i][g] = grid[i];
+  }
+
+  const __m128i lo_table = _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64,
+                                         static_cast<char>(0x80), 0, 0, 0, 0,
+                                         0, 0, 0);
+  const __m128i hi_table =
+      _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0);
+  const __m128i max_value = _mm_set1_epi8(SudokuGrid::kSize);
+  const __m128i zero = _mm_setzero_si128();
+
+  __m128i lo[SudokuGrid::kCellCount];
+  __m128i hi[SudokuGrid::kCellCount];
+  __m128i out_of_range = zero;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    const __m128i v =
+        _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[i]));
+    out_of_range = _mm_or_si128(out_of_range, _mm_subs_epu8(v, max_value));
+    lo[i] = _mm_shuffle_epi8(lo_table, v);
+    hi[i] = _mm_shuffle_epi8(hi_table, v);
+  }
+
+  const UnitCellTable& units = UnitCells();
+  alignas(16) std::uint8_t kind_dup[3][kLanes];
+  for (int kind = 0; kind < 3; ++kind) {
+    __m128i dup = zero;
+    for (int u = kind * SudokuGrid::kSize; u < (kind + 1) * SudokuGrid::kSize;
+         ++u) {
+      __m128i seen_lo = zero;
+      __m128i seen_hi = zero;
+      for (int i : units[u]) {
+        dup = _mm_or_si128(dup, _mm_and_si128(seen_lo, lo[i]));
+        dup = _mm_or_si128(dup, _mm_and_si128(seen_hi, hi[i]));
+        seen_lo = _mm_or_si128(seen_lo, lo[i]);
+        seen_hi = _mm_or_si128(seen_hi, hi[i]);
+      }
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(kind_dup[kind]), dup);
+  }
+
+  alignas(16) std::uint8_t range[kLanes];
+  _mm_store_si128(reinterpret_cast<__m128i*>(range), out_of_range);
+
+  for (int g = 0; g < kLanes; ++g) {
+    if (range[g] != 0) {
+      results[g] = kValueOutOfRange;
+      continue;
+    }
+    results[g] = static_cast<std::uint8_t>(
+        (kind_dup[0][g] != 0 ? kRowConflict : 0) |
+        (kind_dup[1][g] != 0 ? kColConflict : 0) |
+        (kind_dup[2][g] != 0 ? kBoxConflict : 0));
+  }
+}
+
+bool CpuHasSsse3() {
+  static const bool has = __builtin_cpu_supports("ssse3") != 0;
+  return has;
+}
+
+#endif  // SUDOKU_HAVE_SSSE3_KERNEL
+
+}  // namespace
+
+void ValidateCellBlocks(const std::uint8_t* cells, std::size_t count,
+                        std::uint8_t* results) {
+  if (cells == nullptr || results == nullptr) return;
+
+  std::size_t i = 0;
+#ifdef SUDOKU_HAVE_SSSE3_KERNEL
+  if (CpuHasSsse3()) {
+    for (; i + kLanes <= count; i += kLanes) {
+      ValidateLanesSsse3(cells + i * SudokuGrid::kCellCount, results + i);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = ValidateOne(cells + i * SudokuGrid::kCellCount);
+  }
+}
+
+bool DescribeCellBlock(const std::uint8_t* cells, std::string* reason) {
+  if (cells == nullptr) {
+    if (reason) *reason = "внутренняя ошибка: cells == nullptr";
+    return false;
+  }
+
+  SudokuGrid grid;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (cells[i] > SudokuGrid::kSize) {
+      if (reason) *reason = "значение вне диапазона 0..9";
+      return false;
+    }
+    grid.SetCell(i, cells[i]);
+  }
+  return IsGridValid(grid, reason);
+}
+
+}  // namespace sudoku
@@ -0,0 +1,35 @@
+#ifndef SUDOKU_BATCH_VALIDATOR_H_
+#define SUDOKU_BATCH_VALIDATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Результат проверки одного поля: 0 — корректно, иначе набор флагов.
+enum ValidationFlag : std::uint8_t {
+  kValidationOk = 0,
+  kRowConflict = 1 << 0,
+  kColConflict = 1 << 1,
+  kBoxConflict = 1 << 2,
+  kValueOutOfRange = 1 << 3,  // Прочие флаги такого поля не определены.
+};
+
+// Пакетная проверка сырых полей: count подряд идущих блоков по 81 байту
+// (значения клеток 0..9, 0 — пусто), результат — по байту флагов на поле.
+// На x86 с SSSE3 проверяется по 16 полей за раз: поля раскладываются по
+// байтовым дорожкам, цифра превращается в бит через pshufb, повторы в 27
+// группах ищутся сразу для всех 16 полей. Иначе — скалярный путь.
+void ValidateCellBlocks(const std::uint8_t* cells, std::size_t count,
+                        std::uint8_t* results);
+
+// Подробная причина для одного сырого поля (как у IsGridValid); вызывать
+// стоит только для полей с ненулевым результатом.
+bool DescribeCellBlock(const std::uint8_t* cells, std::string* reason);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_BATCH_VALIDATOR_H_
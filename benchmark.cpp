@@ -0,0 +1,393 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "batch_validator.h"
+#include "dlx_solver.h"
+#include "file_io.h"
+#include "generator.h"
+#include "grid_enumerator.h"
+#include "grid_parser.h"
+#include "parallel_solver.h"
+#include "propagation.h"
+#include "solution_cache.h"
+#include "solver.h"
+#include "variants.h"
+
+namespace sudoku {
+namespace {
+
+constexpr int kPasses = 3;  // Сколько раз прогонять каждый набор задач.
+
+struct Corpus {
+  std::string name;
+  std::vector<SudokuGrid> puzzles;
+};
+
+struct Result {
+  std::size_t ops = 0;
+  double median_us = 0.0;
+  double p99_us = 0.0;
+  double ops_per_sec = 0.0;
+  double allocs_per_op = 0.0;
+};
+
+// Выполняет fn(i) для i из [0, ops). Время замеряется порциями по batch
+// операций (для очень быстрых операций замер одной — это замер часов);
+// медиана и p99 считаются по времени операции внутри порции.
+template <typename Fn>
+Result Measure(std::size_t ops, std::size_t batch, Fn fn) {
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<double> samples;
+  samples.reserve(ops / batch + 1);
+
+  const std::uint64_t allocs_before = AllocationCount();
+  const auto start = Clock::now();
+  for (std::size_t i = 0; i < ops; i += batch) {
+    const std::size_t n = std::min(batch, ops - i);
+    const auto t0 = Clock::now();
+    for (std::size_t k = 0; k < n; ++k) fn(i + k);
+    const auto t1 = Clock::now();
+    const std::chrono::duration<double, std::micro> us = t1 - t0;
+    samples.push_back(us.count() / static_cast<double>(n));
+  }
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  const std::uint64_t allocs = AllocationCount() - allocs_before;
+
+  Result result;
+  result.ops = ops;
+  if (!samples.empty()) {
+    std::sort(samples.begin(), samples.end());
+    result.median_us = samples[samples.size() / 2];
+    const std::size_t p99 = samples.size() * 99 / 100;
+    result.p99_us = samples[std::min(samples.size() - 1, p99)];
+  }
+  result.ops_per_sec = seconds > 0 ? ops / seconds : 0.0;
+  result.allocs_per_op = ops > 0 ? static_cast<double>(allocs) / ops : 0.0;
+  return result;
+}
+
+void PrintHeader(std::ostream* out) {
+  *out << std::left << std::setw(34) << "case" << std::right << std::setw(8)
+       << "ops" << std::setw(12) << "median_us" << std::setw(12) << "p99_us"
+       << std::setw(14) << "ops/s" << std::setw(12) << "allocs/op" << "\n";
+}
+
+void PrintRow(std::ostream* out, const std::string& name, const Result& r) {
+  *out << std::left << std::setw(34) << name << std::right << std::setw(8)
+       << r.ops << std::fixed << std::setprecision(2) << std::setw(12)
+       << r.median_us << std::setw(12) << r.p99_us << std::setprecision(0)
+       << std::setw(14) << r.ops_per_sec << std::setprecision(2)
+       << std::setw(12) << r.allocs_per_op << "\n";
+  out->unsetf(std::ios::floatfield);
+}
+
+// Строка горячего пути (перебор, генерация, перечисление полей): такие
+// замеры не должны выделять память, иначе имя попадает в *allocating и
+// RunBenchmarks завершается ошибкой. allocating == nullptr — выделения
+// допустимы (потоки, кэш и т. п.).
+void PrintHotRow(std::ostream* out, const std::string& name, const Result& r,
+                 std::vector<std::string>* allocating) {
+  PrintRow(out, name, r);
+  if (allocating != nullptr && r.allocs_per_op > 0) {
+    allocating->push_back(name);
+  }
+}
+
+template <typename SolveFn>
+void BenchSolver(std::ostream* out, const std::string& name,
+                 const Corpus& corpus, std::vector<std::string>* allocating,
+                 SolveFn solve) {
+  if (corpus.puzzles.empty()) return;
+  const std::size_t ops = corpus.puzzles.size() * kPasses;
+  const Result r = Measure(ops, 1, [&](std::size_t i) {
+    SudokuGrid work = corpus.puzzles[i % corpus.puzzles.size()];
+    solve(&work);
+  });
+  PrintHotRow(out, name + "/" + corpus.name, r, allocating);
+}
+
+// Генерация и MRV-перебор на поле другого размера: задачи — заполненные
+// поля без 40% клеток (без проверки единственности). При половине пустых
+// клеток 25×25 попадает в область фазового перехода, где чистый MRV
+// работает секундами.
+template <int kBox>
+void BenchBoardSize(std::ostream* out, std::size_t ops, std::mt19937* rng,
+                    std::vector<std::string>* allocating) {
+  using Grid = BasicSudokuGrid<kBox>;
+  const std::string size =
+      std::to_string(Grid::kSize) + "x" + std::to_string(Grid::kSize);
+
+  std::vector<Grid> solved(ops);
+  PrintHotRow(out, "GenerateSolvedGrid(" + size + ")",
+              Measure(ops, 1, [&](std::size_t i) {
+                solved[i] = GenerateSolvedGrid<kBox>(rng);
+              }),
+              allocating);
+
+  std::vector<Grid> puzzles(ops);
+  for (std::size_t i = 0; i < ops; ++i) {
+    puzzles[i] = CreatePuzzle(solved[i], Grid::kCellCount * 2 / 5,
+                              PuzzleCheck::kNone, rng, nullptr);
+  }
+  PrintHotRow(out, "SolveIterative(mrv)/" + size,
+              Measure(ops, 1, [&](std::size_t i) {
+                Grid work = puzzles[i];
+                SolveIterative(&work, CellOrder::kMinRemaining);
+              }),
+              allocating);
+}
+
+// Варианты на тех же заполненных полях. X-судоку: одно решение с
+// диагоналями, цифры переставлены случайно, без половины клеток.
+// Killer: пустое поле, клетки по две соседние в строке с суммами из
+// заполненного поля (решений может быть несколько, ищется первое).
+void BenchVariants(std::ostream* out, const std::vector<SudokuGrid>& solved,
+                   std::mt19937* rng) {
+  const std::size_t ops = solved.size();
+  ConstraintSet diagonal;
+  diagonal.AddDiagonals(nullptr);
+  SudokuGrid base;
+  SolveVariant(&base, diagonal, nullptr);
+
+  std::vector<SudokuGrid> x_puzzles(ops);
+  std::vector<ConstraintSet> killer_sets(ops);
+  std::array<int, SudokuGrid::kSize + 1> digits{};
+  for (std::size_t g = 0; g < ops; ++g) {
+    for (int v = 0; v <= SudokuGrid::kSize; ++v) digits[v] = v;
+    std::shuffle(digits.begin() + 1, digits.end(), *rng);
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+      if ((*rng)() % 2 == 0) x_puzzles[g].SetCell(i, digits[base.GetCell(i)]);
+    }
+    for (int r = 0; r < SudokuGrid::kSize; ++r) {
+      for (int c = 0; c < SudokuGrid::kSize; c += 2) {
+        const int i = r * SudokuGrid::kSize + c;
+        std::vector<int> cells = {i};
+        int sum = solved[g].GetCell(i);
+        if (c + 1 < SudokuGrid::kSize) {
+          cells.push_back(i + 1);
+          sum += solved[g].GetCell(i + 1);
+        }
+        killer_sets[g].AddCage(cells, sum, nullptr);
+      }
+    }
+  }
+
+  PrintRow(out, "SolveVariant(diagonal)",
+           Measure(ops, 1, [&](std::size_t i) {
+             SudokuGrid work = x_puzzles[i];
+             SolveVariant(&work, diagonal, nullptr);
+           }));
+  PrintRow(out, "SolveVariant(killer,2-cell)",
+           Measure(ops, 1, [&](std::size_t i) {
+             SudokuGrid work;
+             SolveVariant(&work, killer_sets[i], nullptr);
+           }));
+}
+
+}  // namespace
+
+bool RunBenchmarks(const BenchmarkOptions& options, std::ostream* out,
+                   std::string* error) {
+  if (out == nullptr) {
+    if (error) *error = "внутренняя ошибка: out == nullptr";
+    return false;
+  }
+
+  BulkGenerateOptions easy_options;
+  easy_options.use_difficulty = true;
+  easy_options.difficulty = Difficulty::kEasy;
+  easy_options.seed = options.seed;
+
+  std::vector<Corpus> corpora(3);
+  corpora[0].name = "easy";
+  GeneratePuzzles(easy_options, 0, options.easy_count, &corpora[0].puzzles);
+
+  corpora[1].name = "hard";
+  corpora[2].name = "minimal";
+  const std::string files[] = {"puzzles_hard.txt", "puzzles_17.txt"};
+  for (int k = 0; k < 2; ++k) {
+    const std::string path = options.corpus_dir + "/" + files[k];
+    std::string load_error;
+    if (!LoadGrids(path, &corpora[k + 1].puzzles, &load_error)) {
+      if (error) *error = path + ": " + load_error;
+      return false;
+    }
+  }
+
+  *out << "Наборы: easy " << corpora[0].puzzles.size() << ", hard "
+       << corpora[1].puzzles.size() << ", minimal "
+       << corpora[2].puzzles.size() << " задач; проходов по набору: "
+       << kPasses << "\n";
+  PrintHeader(out);
+  std::vector<std::string> allocating;
+
+  // Построчный перебор на трудных наборах работает секундами на задачу,
+  // поэтому замеряется только на лёгком.
+  BenchSolver(out, "SolveIterative(row)", corpora[0], &allocating,
+              [](SudokuGrid* g) { return SolveIterative(g); });
+  for (const Corpus& corpus : corpora) {
+    BenchSolver(out, "SolveIterative(mrv)", corpus, &allocating,
+                [](SudokuGrid* g) {
+                  return SolveIterative(g, CellOrder::kMinRemaining);
+                });
+    BenchSolver(out, "SolveWithPropagation", corpus, &allocating,
+                [](SudokuGrid* g) {
+                  return SolveWithPropagation(g, nullptr);
+                });
+    BenchSolver(out, "SolveDlx", corpus, &allocating,
+                [](SudokuGrid* g) { return SolveDlx(g); });
+  }
+  // Параллельный перебор имеет смысл только на трудных задачах: на лёгких
+  // запуск потоков дороже самого решения.
+  for (int k = 1; k < 3; ++k) {
+    BenchSolver(out, "SolveParallel", corpora[k], nullptr, [](SudokuGrid* g) {
+      return SolveParallel(g, ParallelSolveOptions(), nullptr);
+    });
+  }
+  // Попадание в кэш решений: каноническая форма задачи, поиск и перевод
+  // решения обратно в ориентацию задачи.
+  SolutionCache cache(corpora[1].puzzles.size() + corpora[2].puzzles.size());
+  for (int k = 1; k < 3; ++k) {
+    for (SudokuGrid g : corpora[k].puzzles) cache.Solve(&g, nullptr, nullptr);
+    BenchSolver(out, "SolutionCache(hit)", corpora[k], nullptr,
+                [&](SudokuGrid* g) { return cache.Solve(g, nullptr, nullptr); });
+  }
+  // Классический набор ограничений должен идти по быстрому пути.
+  const ConstraintSet classic;
+  BenchSolver(out, "SolveVariant(classic)", corpora[1], &allocating,
+              [&](SudokuGrid* g) { return SolveVariant(g, classic, nullptr); });
+
+  std::mt19937 rng(static_cast<std::uint32_t>(options.seed));
+  std::vector<SudokuGrid> solved(options.generate_count);
+  PrintHotRow(out, "GenerateSolvedGrid",
+              Measure(options.generate_count, 1, [&](std::size_t i) {
+                solved[i] = GenerateSolvedGrid(&rng);
+              }),
+              &allocating);
+  PrintHotRow(out, "GenerateRandomSolvedGrid",
+              Measure(options.generate_count, 1, [&](std::size_t i) {
+                solved[i] = GenerateRandomSolvedGrid(&rng);
+              }),
+              &allocating);
+  SolvedGridEnumerator enumerator{SudokuGrid()};
+  SudokuGrid enumerated;
+  PrintHotRow(out, "SolvedGridEnumerator::Next",
+              Measure(options.generate_count, 1, [&](std::size_t) {
+                enumerator.Next(&enumerated);
+              }),
+              &allocating);
+
+  const PuzzleCheck checks[] = {PuzzleCheck::kNone, PuzzleCheck::kUnique};
+  const char* check_names[] = {"CreatePuzzle(none,81)",
+                               "CreatePuzzle(unique,81)"};
+  for (int k = 0; k < 2; ++k) {
+    PrintHotRow(out, check_names[k],
+                Measure(options.generate_count, 1, [&](std::size_t i) {
+                  CreatePuzzle(solved[i], SudokuGrid::kCellCount, checks[k],
+                               &rng, nullptr);
+                }),
+                &allocating);
+  }
+
+  const ClueSymmetry symmetries[] = {ClueSymmetry::kNone,
+                                     ClueSymmetry::kRotational};
+  const char* symmetry_names[] = {"CreateMinimalPuzzle(none)",
+                                  "CreateMinimalPuzzle(rotational)"};
+  for (int k = 0; k < 2; ++k) {
+    PrintHotRow(out, symmetry_names[k],
+                Measure(options.generate_count, 1, [&](std::size_t i) {
+                  CreateMinimalPuzzle(solved[i], symmetries[k], &rng);
+                }),
+                &allocating);
+  }
+
+  BenchVariants(out, solved, &rng);
+  BenchBoardSize<2>(out, options.generate_count, &rng, &allocating);
+  BenchBoardSize<4>(out, options.generate_count, &rng, &allocating);
+  BenchBoardSize<5>(out, options.generate_count, &rng, &allocating);
+
+  // Невалидное поле: повтор в первой строке.
+  std::vector<SudokuGrid> invalid = solved;
+  for (SudokuGrid& g : invalid) g.SetCell(1, g.GetCell(0));
+
+  constexpr std::size_t kValidateBatch = 1000;
+  const std::size_t validate_ops = options.generate_count * kValidateBatch;
+  std::size_t valid_count = 0;
+  PrintRow(out, "IsGridValid(valid)",
+           Measure(validate_ops, kValidateBatch, [&](std::size_t i) {
+             valid_count += IsGridValid(solved[i % solved.size()], nullptr);
+           }));
+  PrintRow(out, "IsGridValid(invalid,reason)",
+           Measure(options.generate_count, 1, [&](std::size_t i) {
+             std::string reason;
+             valid_count += IsGridValid(invalid[i], &reason);
+           }));
+
+  // Сырые поля (как приходят от пользователей): чётные корректны,
+  // нечётные с повтором. Одна операция — проверка 16 полей.
+  constexpr std::size_t kBlockGroup = 16;
+  std::vector<std::uint8_t> raw(2 * solved.size() * SudokuGrid::kCellCount);
+  for (std::size_t g = 0; g < 2 * solved.size(); ++g) {
+    const SudokuGrid& src = g % 2 == 0 ? solved[g / 2] : invalid[g / 2];
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+      raw[g * SudokuGrid::kCellCount + i] =
+          static_cast<std::uint8_t>(src.GetCell(i));
+    }
+  }
+  const std::size_t groups = raw.size() / SudokuGrid::kCellCount / kBlockGroup;
+  std::vector<std::uint8_t> flags(kBlockGroup);
+  PrintRow(out, "ValidateCellBlocks(x16)",
+           Measure(groups * kValidateBatch / 10, kValidateBatch / 10,
+                   [&](std::size_t i) {
+                     const std::size_t first = (i % groups) * kBlockGroup;
+                     ValidateCellBlocks(
+                         raw.data() + first * SudokuGrid::kCellCount,
+                         kBlockGroup, flags.data());
+                   }));
+
+  // Разбор текста: чётные поля компактные, нечётные — в рамке
+  // ToPrettyString. Одна операция — разбор одного поля из общего буфера.
+  std::string text;
+  std::vector<std::size_t> offsets;
+  for (std::size_t g = 0; g < solved.size(); ++g) {
+    offsets.push_back(text.size());
+    text += g % 2 == 0 ? solved[g].ToCompactString()
+                       : solved[g].ToPrettyString();
+    text += '\n';
+  }
+  offsets.push_back(text.size());
+  std::size_t parsed = 0;
+  PrintRow(out, "GridParser(compact+pretty)",
+           Measure(validate_ops, kValidateBatch, [&](std::size_t i) {
+             const std::size_t g = i % solved.size();
+             GridParser parser(text.data() + offsets[g],
+                               offsets[g + 1] - offsets[g]);
+             SudokuGrid grid;
+             parsed += parser.Next(&grid);
+           }));
+
+  if (valid_count != validate_ops || parsed != validate_ops) {
+    if (error) *error = "проверка или разбор вернули неожиданный результат";
+    return false;
+  }
+  if (!allocating.empty()) {
+    if (error) {
+      *error = "выделения памяти на горячем пути:";
+      for (const std::string& name : allocating) *error += " " + name;
+    }
+    return false;
+  }
+
+  if (error) *error = "";
+  return true;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,34 @@
+#ifndef SUDOKU_BENCHMARK_H_
+#define SUDOKU_BENCHMARK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace sudoku {
+
+struct BenchmarkOptions {
+  std::string corpus_dir = ".";    // Где лежат puzzles_hard.txt и puzzles_17.txt.
+  std::size_t easy_count = 500;    // Размер сгенерированного лёгкого набора.
+  std::size_t generate_count = 200;  // Операций для замеров генератора.
+  std::uint64_t seed = 1;
+};
+
+// Замеряет SolveIterative (построчно и MRV), SolveWithPropagation, SolveDlx,
+// GenerateSolvedGrid, CreatePuzzle и IsGridValid на наборах easy
+// (сгенерированные лёгкие задачи), hard (puzzles_hard.txt) и minimal
+// (задачи с 17 подсказками, puzzles_17.txt). Для каждого замера выводит
+// медиану и p99 времени операции, операций в секунду и выделений памяти на
+// операцию (в потоке замера: у SolveParallel рабочие потоки не считаются,
+// см. alloc_counter.h). Генерация и MRV-перебор замеряются также на полях
+// 4×4, 16×16 и 25×25, SolveVariant — на X-судоку и killer.
+// Перебор, генерация и перечисление полей должны работать без выделений
+// памяти: если такой замер показал allocs/op > 0, функция возвращает false
+// со списком замеров в *error (замеры при этом выведены полностью).
+bool RunBenchmarks(const BenchmarkOptions& options, std::ostream* out,
+                   std::string* error);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_BENCHMARK_H_
@@ -0,0 +1,33 @@
+#ifndef SUDOKU_BITS_H_
+#define SUDOKU_BITS_H_
+
+namespace sudoku {
+
+// Число установленных битов в маске кандидатов.
+inline int PopCount(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcount(mask);
+#else
+  int n = 0;
+  for (; mask != 0; mask &= mask - 1) ++n;
+  return n;
+#endif
+}
+
+// Номер младшего установленного бита (mask != 0).
+inline int LowestBit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz(mask);
+#else
+  int n = 0;
+  while ((mask & 1u) == 0) {
+    mask >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_BITS_H_
@@ -0,0 +1,378 @@
+#include "canonical.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+namespace {
+
+constexpr int kSize = SudokuGrid::kSize;
+constexpr int kBoxSize = SudokuGrid::kBoxSize;
+
+using Line = std::array<std::uint8_t, kSize>;
+using Labels = std::array<std::uint8_t, kSize + 1>;
+using Triple = std::array<std::uint8_t, kBoxSize>;
+
+// Частичный результат: ориентация, выбранные строки и разметка цифр по
+// первому появлению. Порядок столбцов выбран не до конца: cols — текущий
+// порядок, а ещё ничем не различённые столбцы одного стека образуют ячейку
+// (бит j в cell_start — позиция j начинает ячейку). Так же стеки одной
+// группы слотов (stack_start) взаимозаменяемы целиком. Каждая строка
+// уточняет разбиение ровно настолько, насколько нужно для её наименьшей
+// записи, поэтому 1296 перестановок столбцов не перебираются.
+struct Candidate {
+  std::uint8_t transpose = 0;
+  std::uint16_t used_rows = 0;
+  std::uint8_t next_label = 1;
+  Line rows{};
+  Labels labels{};  // 0 — цифра ещё не встречалась.
+  Line cols = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+  std::uint16_t cell_start = 1u | 1u << 3 | 1u << 6;
+  std::uint8_t stack_start = 1;
+};
+
+// Вариант раскладки одного стека в очередной строке.
+struct StackOption {
+  Triple cols{};
+  Triple out{};
+  unsigned cell_start = 0;  // Биты 0..2 — ячейки стека после строки.
+  Labels labels{};
+  std::uint8_t next_label = 0;
+  int source = 0;  // Слот, из которого взят стек.
+};
+
+// Стек из трёх слотов группы, до 3! порядков новых цифр в каждом.
+constexpr int kMaxSlotOptions = kBoxSize * 6;
+using SlotOptions = std::array<StackOption, kMaxSlotOptions>;
+
+// -1, 0, 1 — сравнение первых n элементов.
+int ComparePrefix(const Line& a, const Line& b, int n) {
+  for (int k = 0; k < n; ++k) {
+    if (a[k] != b[k]) return a[k] < b[k] ? -1 : 1;
+  }
+  return 0;
+}
+
+// Сортировка вставками первых n (не больше трёх) элементов.
+template <typename Less>
+void SortSmall(Triple* items, int n, Less less) {
+  for (int i = 1; i < n; ++i) {
+    for (int k = i; k > 0 && less((*items)[k], (*items)[k - 1]); --k) {
+      std::swap((*items)[k], (*items)[k - 1]);
+    }
+  }
+}
+
+bool IsZeroStack(const Line& row, const Line& cols, int slot) {
+  for (int k = 0; k < kBoxSize; ++k) {
+    if (row[cols[slot * kBoxSize + k]] != 0) return false;
+  }
+  return true;
+}
+
+// Все наименьшие раскладки стека в строке row: в ячейке сначала пустые
+// клетки, затем размеченные цифры по возрастанию метки, затем новые.
+// Запись от порядка новых цифр не зависит, а разметка зависит, поэтому
+// каждый их порядок — отдельный вариант. Пустые клетки остаются одной
+// ячейкой, каждая цифра становится отдельной.
+class StackArranger {
+ public:
+  StackArranger(const Line& row, const Triple& cols, unsigned cell_start,
+                const StackOption& start, SlotOptions* options, int* count)
+      : row_(row),
+        cols_(cols),
+        cell_start_(cell_start),
+        option_(start),
+        options_(options),
+        count_(count) {}
+
+  void Run() { Cell(0); }
+
+ private:
+  void Cell(int begin) {
+    if (begin == kBoxSize) {
+      (*options_)[(*count_)++] = option_;
+      return;
+    }
+    int end = begin + 1;
+    while (end < kBoxSize && (cell_start_ & (1u << end)) == 0) ++end;
+
+    Triple zeros{}, known{}, fresh{};
+    int nz = 0, nk = 0, nf = 0;
+    for (int k = begin; k < end; ++k) {
+      const int v = row_[cols_[k]];
+      if (v == 0) {
+        zeros[nz++] = cols_[k];
+      } else if (option_.labels[v] != 0) {
+        known[nk++] = cols_[k];
+      } else {
+        fresh[nf++] = cols_[k];
+      }
+    }
+    SortSmall(&known, nk, [&](std::uint8_t a, std::uint8_t b) {
+      return option_.labels[row_[a]] < option_.labels[row_[b]];
+    });
+    SortSmall(&fresh, nf, [](std::uint8_t a, std::uint8_t b) { return a < b; });
+
+    const StackOption saved = option_;
+    do {
+      int p = begin;
+      for (int k = 0; k < nz; ++k) {
+        if (k == 0) option_.cell_start |= 1u << p;
+        option_.cols[p] = zeros[k];
+        option_.out[p++] = 0;
+      }
+      for (int k = 0; k < nk; ++k) {
+        option_.cell_start |= 1u << p;
+        option_.cols[p] = known[k];
+        option_.out[p++] = option_.labels[row_[known[k]]];
+      }
+      for (int k = 0; k < nf; ++k) {
+        option_.cell_start |= 1u << p;
+        option_.cols[p] = fresh[k];
+        option_.labels[row_[fresh[k]]] = option_.next_label++;
+        option_.out[p++] = option_.labels[row_[fresh[k]]];
+      }
+      Cell(end);
+      option_ = saved;
+    } while (std::next_permutation(fresh.begin(), fresh.begin() + nf));
+  }
+
+  const Line& row_;
+  const Triple& cols_;
+  const unsigned cell_start_;
+  StackOption option_;
+  SlotOptions* options_;
+  int* count_;
+};
+
+// Наименьшая запись строки для кандидатов уровня: слоты стеков
+// заполняются слева направо, на каждом остаются только варианты с
+// наименьшей тройкой. В next попадают кандидаты, дающие наименьшую запись
+// best среди всех уже рассмотренных.
+class RowArranger {
+ public:
+  RowArranger(Line* best, std::vector<Candidate>* next)
+      : best_(best), next_(next) {}
+
+  void Run(const Candidate& cand, const Line& row, int level, int row_index) {
+    row_ = &row;
+    work_ = cand;
+    work_.rows[level] = static_cast<std::uint8_t>(row_index);
+    work_.used_rows =
+        static_cast<std::uint16_t>(work_.used_rows | (1u << row_index));
+    work_.cell_start = 0;
+    old_cells_ = cand.cell_start;
+    Slot(0);
+  }
+
+ private:
+  void Slot(int slot) {
+    if (slot == kBoxSize) {
+      Finish();
+      return;
+    }
+
+    int group_end = slot + 1;
+    while (group_end < kBoxSize &&
+           (work_.stack_start & (1u << group_end)) == 0) {
+      ++group_end;
+    }
+
+    // Любой ещё не поставленный стек группы (пустые в этой строке
+    // неразличимы — берётся первый) и любая его наименьшая раскладка.
+    SlotOptions& options = options_[slot];
+    int count = 0;
+    bool zero_seen = false;
+    StackOption start;
+    start.labels = work_.labels;
+    start.next_label = work_.next_label;
+    for (int s = slot; s < group_end; ++s) {
+      if (IsZeroStack(*row_, work_.cols, s)) {
+        if (zero_seen) continue;
+        zero_seen = true;
+      }
+      Triple cols{};
+      unsigned cells = 0;
+      for (int k = 0; k < kBoxSize; ++k) {
+        cols[k] = work_.cols[s * kBoxSize + k];
+        if ((old_cells_ & (1u << (s * kBoxSize + k))) != 0) cells |= 1u << k;
+      }
+      start.source = s;
+      StackArranger(*row_, cols, cells, start, &options, &count).Run();
+    }
+
+    Triple min_out = options[0].out;
+    for (int i = 1; i < count; ++i) min_out = std::min(min_out, options[i].out);
+    const int p = slot * kBoxSize;
+    std::copy(min_out.begin(), min_out.end(), prefix_.begin() + p);
+    if (have_best_ && ComparePrefix(prefix_, *best_, p + kBoxSize) > 0) {
+      return;
+    }
+
+    const Candidate saved = work_;
+    const unsigned saved_cells = old_cells_;
+    for (int i = 0; i < count; ++i) {
+      const StackOption& o = options[i];
+      if (o.out != min_out) continue;
+      // Выбранный стек (с его прежним разбиением) меняется местами со
+      // стеком слота, затем раскладывается.
+      for (int k = 0; k < kBoxSize; ++k) {
+        const int a = p + k;
+        const int b = o.source * kBoxSize + k;
+        std::swap(work_.cols[a], work_.cols[b]);
+        const unsigned bit_a = (old_cells_ >> a) & 1u;
+        const unsigned bit_b = (old_cells_ >> b) & 1u;
+        old_cells_ &= ~((1u << a) | (1u << b));
+        old_cells_ |= (bit_b << a) | (bit_a << b);
+        work_.cols[a] = o.cols[k];
+      }
+      std::copy(o.out.begin(), o.out.end(), prefix_.begin() + p);
+      work_.cell_start =
+          static_cast<std::uint16_t>(work_.cell_start | (o.cell_start << p));
+      work_.labels = o.labels;
+      work_.next_label = o.next_label;
+      Slot(slot + 1);
+      work_ = saved;
+      old_cells_ = saved_cells;
+    }
+  }
+
+  void Finish() {
+    const int cmp = have_best_ ? ComparePrefix(prefix_, *best_, kSize) : -1;
+    if (cmp > 0) return;
+    if (cmp < 0) {
+      next_->clear();
+      *best_ = prefix_;
+      have_best_ = true;
+    }
+    // Соседние стеки группы остаются взаимозаменяемыми, только если в
+    // этой строке оба пусты.
+    Candidate child = work_;
+    child.stack_start = 1;
+    for (int s = 1; s < kBoxSize; ++s) {
+      if ((work_.stack_start & (1u << s)) != 0 ||
+          !IsZeroStack(*row_, child.cols, s - 1) ||
+          !IsZeroStack(*row_, child.cols, s)) {
+        child.stack_start = static_cast<std::uint8_t>(child.stack_start |
+                                                      (1u << s));
+      }
+    }
+    next_->push_back(child);
+  }
+
+  Line* best_;
+  std::vector<Candidate>* next_;
+  bool have_best_ = false;
+  const Line* row_ = nullptr;
+  Candidate work_;
+  unsigned old_cells_ = 0;  // Разбиение столбцов до этой строки.
+  Line prefix_{};
+  std::array<SlotOptions, kBoxSize> options_;
+};
+
+}  // namespace
+
+SudokuGrid ApplyTransform(const SudokuGrid& grid,
+                          const GridTransform& transform) {
+  SudokuGrid result;
+  for (int i = 0; i < kSize; ++i) {
+    for (int j = 0; j < kSize; ++j) {
+      const int r = transform.rows[i];
+      const int c = transform.cols[j];
+      const int v = transform.transpose ? grid.GetCell(c * kSize + r)
+                                        : grid.GetCell(r * kSize + c);
+      result.SetCell(i * kSize + j, transform.digits[v]);
+    }
+  }
+  return result;
+}
+
+SudokuGrid ApplyInverseTransform(const SudokuGrid& grid,
+                                 const GridTransform& transform) {
+  Labels inverse{};
+  for (int v = 0; v <= kSize; ++v) {
+    inverse[transform.digits[v]] = static_cast<std::uint8_t>(v);
+  }
+
+  SudokuGrid result;
+  for (int i = 0; i < kSize; ++i) {
+    for (int j = 0; j < kSize; ++j) {
+      const int r = transform.rows[i];
+      const int c = transform.cols[j];
+      const int index = transform.transpose ? c * kSize + r : r * kSize + c;
+      result.SetCell(index, inverse[grid.GetCell(i * kSize + j)]);
+    }
+  }
+  return result;
+}
+
+SudokuGrid CanonicalForm(const SudokuGrid& grid, GridTransform* transform) {
+  // src[t][r][c] — клетка в ориентации t (1 — транспонированное поле).
+  std::array<std::array<Line, kSize>, 2> src{};
+  std::array<std::array<bool, kSize>, 2> row_empty{};
+  for (int r = 0; r < kSize; ++r) {
+    for (int c = 0; c < kSize; ++c) {
+      const auto v = static_cast<std::uint8_t>(grid.GetCell(r * kSize + c));
+      src[0][r][c] = v;
+      src[1][c][r] = v;
+    }
+  }
+  for (int t = 0; t < 2; ++t) {
+    for (int r = 0; r < kSize; ++r) {
+      row_empty[t][r] = std::all_of(src[t][r].begin(), src[t][r].end(),
+                                    [](std::uint8_t v) { return v == 0; });
+    }
+  }
+
+  // Буферы переживают вызов: в пакетной работе форма считается на каждую
+  // задачу, и выделять их заново незачем.
+  thread_local std::vector<Candidate> current;
+  thread_local std::vector<Candidate> next;
+  current.assign(2, Candidate());
+  current[1].transpose = 1;
+
+  SudokuGrid result;
+  for (int level = 0; level < kSize; ++level) {
+    next.clear();
+    Line best{};
+    RowArranger arranger(&best, &next);
+    for (const Candidate& cand : current) {
+      const int band =
+          level % kBoxSize == 0 ? -1 : cand.rows[level - 1] / kBoxSize;
+      unsigned empty_bands_seen = 0;
+      for (int r = 0; r < kSize; ++r) {
+        const int r_band = r / kBoxSize;
+        if (band >= 0) {
+          if (r_band != band || (cand.used_rows & (1u << r)) != 0) continue;
+        } else if ((cand.used_rows & (7u << (r_band * kBoxSize))) != 0) {
+          continue;  // Новая полоса начинается только с нетронутой.
+        }
+        // Пустые строки одной полосы взаимозаменяемы.
+        if (row_empty[cand.transpose][r]) {
+          if ((empty_bands_seen & (1u << r_band)) != 0) continue;
+          empty_bands_seen |= 1u << r_band;
+        }
+        arranger.Run(cand, src[cand.transpose][r], level, r);
+      }
+    }
+    std::swap(current, next);
+    for (int j = 0; j < kSize; ++j) result.SetCell(level * kSize + j, best[j]);
+  }
+
+  if (transform != nullptr) {
+    const Candidate& winner = current.front();
+    transform->transpose = winner.transpose != 0;
+    transform->rows = winner.rows;
+    transform->cols = winner.cols;
+    transform->digits = winner.labels;
+    std::uint8_t label = winner.next_label;
+    for (int v = 1; v <= kSize; ++v) {
+      if (transform->digits[v] == 0) transform->digits[v] = label++;
+    }
+  }
+  return result;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,46 @@
+#ifndef SUDOKU_CANONICAL_H_
+#define SUDOKU_CANONICAL_H_
+
+#include <array>
+#include <cstdint>
+
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Преобразование симметрии поля 9×9 — те же операции, которыми
+// GenerateSolvedGrid строит поля: транспонирование, перестановки полос и
+// строк внутри полос, стеков и столбцов внутри стеков, перестановка цифр.
+// Корректное поле переходит в корректное, решение — в решение.
+struct GridTransform {
+  bool transpose = false;  // Сначала транспонировать исходное поле.
+  // Строка i результата — строка rows[i] (транспонированного) исходного,
+  // столбец j — столбец cols[j].
+  std::array<std::uint8_t, SudokuGrid::kSize> rows{};
+  std::array<std::uint8_t, SudokuGrid::kSize> cols{};
+  // digits[v] — цифра результата вместо цифры v; digits[0] = 0.
+  std::array<std::uint8_t, SudokuGrid::kSize + 1> digits{};
+};
+
+SudokuGrid ApplyTransform(const SudokuGrid& grid,
+                          const GridTransform& transform);
+// Обратное преобразование: ApplyInverseTransform(ApplyTransform(g, t), t)
+// == g. Им решение канонической формы возвращается к исходной ориентации.
+SudokuGrid ApplyInverseTransform(const SudokuGrid& grid,
+                                 const GridTransform& transform);
+
+// Каноническая форма: лексикографически наименьшая компактная строка
+// (пусто = 0) среди всех полей, эквивалентных grid. Эквивалентные задачи
+// (и повторы) дают одну и ту же форму. transform (может быть nullptr) —
+// преобразование grid в каноническую форму; цифры, которых нет в grid,
+// отображаются на оставшиеся по возрастанию.
+//
+// Перебор идёт по строкам результата; порядок столбцов уточняется лишь
+// настолько, насколько это нужно для наименьшей записи очередной строки.
+// На задачу уходят десятки микросекунд; на заполненное поле, где все
+// варианты первых строк равны, — миллисекунды.
+SudokuGrid CanonicalForm(const SudokuGrid& grid, GridTransform* transform);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_CANONICAL_H_
@@ -0,0 +1,527 @@
+#include "cli.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "benchmark.h"
+#include "console_ui.h"
+#include "corpus.h"
+#include "dlx_solver.h"
+#include "generator.h"
+#include "grader.h"
+#include "grid_parser.h"
+#include "puzzle_store.h"
+#include "solution_cache.h"
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace cli {
+namespace {
+
+constexpr std::size_t kBatchCacheCapacity = 1 << 16;
+
+class CommandLine;
+using CommandHandler = int (*)(const CommandLine& args);
+
+struct Command {
+  const char* name;
+  const char* usage;     // Аргументы после имени подкоманды.
+  const char* values;    // Флаги со значением, через пробел.
+  const char* switches;  // Флаги без значения, через пробел.
+  std::size_t max_positional;  // Аргументов в старом позиционном порядке.
+  CommandHandler run;
+};
+
+// true, если в списке имён через пробел есть name.
+bool ListHas(const char* list, const std::string& name) {
+  const char* p = list;
+  while (*p != '\0') {
+    while (*p == ' ') ++p;
+    const char* end = p;
+    while (*end != '\0' && *end != ' ') ++end;
+    if (end != p && name == std::string(p, end)) return true;
+    p = end;
+  }
+  return false;
+}
+
+// Разобранные аргументы подкоманды: флаги "--имя значение",
+// "--имя=значение", переключатели "--имя" и позиционные аргументы
+// (после "--" все аргументы позиционные; "-" — тоже позиционный).
+class CommandLine {
+ public:
+  bool Parse(const Command& command, int argc, char* argv[],
+             std::string* error) {
+    bool flags_done = false;
+    for (int i = 2; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (flags_done || arg.size() < 2 || arg.compare(0, 2, "--") != 0) {
+        positional_.push_back(arg);
+        continue;
+      }
+      if (arg == "--") {
+        flags_done = true;
+        continue;
+      }
+
+      std::string name = arg.substr(2);
+      std::string value;
+      const std::size_t eq = name.find('=');
+      const bool inline_value = eq != std::string::npos;
+      if (inline_value) {
+        value = name.substr(eq + 1);
+        name.resize(eq);
+      }
+
+      if (name == "help" || ListHas(command.switches, name)) {
+        if (inline_value) {
+          *error = "флаг --" + name + " не принимает значения";
+          return false;
+        }
+        flags_[name] = "";
+      } else if (ListHas(command.values, name)) {
+        if (!inline_value) {
+          if (i + 1 >= argc) {
+            *error = "нет значения у флага --" + name;
+            return false;
+          }
+          value = argv[++i];
+        }
+        flags_[name] = value;
+      } else {
+        *error = "неизвестный флаг " + arg;
+        return false;
+      }
+    }
+    if (positional_.size() > command.max_positional) {
+      *error = "лишний аргумент " + positional_[command.max_positional];
+      return false;
+    }
+    return true;
+  }
+
+  // Индекс для флагов, у которых нет места в позиционном синтаксисе.
+  static constexpr std::size_t kFlagOnly = static_cast<std::size_t>(-1);
+
+  bool Has(const std::string& name) const { return flags_.count(name) != 0; }
+
+  // Значение флага name; без флага — позиционный аргумент index (старый
+  // синтаксис); без обоих — fallback.
+  std::string Get(const std::string& name, std::size_t index,
+                  const std::string& fallback) const {
+    const auto it = flags_.find(name);
+    if (it != flags_.end()) return it->second;
+    if (index < positional_.size()) return positional_[index];
+    return fallback;
+  }
+
+  bool IsSet(const std::string& name, std::size_t index) const {
+    return Has(name) || index < positional_.size();
+  }
+
+  const std::vector<std::string>& positional() const { return positional_; }
+
+ private:
+  std::map<std::string, std::string> flags_;
+  std::vector<std::string> positional_;
+};
+
+bool SolveMrv(sudoku::SudokuGrid* grid, sudoku::SolveStats* stats) {
+  return sudoku::SolveIterative(grid, sudoku::CellOrder::kMinRemaining,
+                                stats);
+}
+
+bool ParseUint64(const std::string& text, std::uint64_t* out) {
+  if (text.empty() || text[0] == '-') return false;
+  char* end = nullptr;
+  errno = 0;
+  const unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+  if (errno != 0 || *end != '\0') return false;
+  *out = value;
+  return true;
+}
+
+bool ParseThreadCount(const std::string& text, int* out) {
+  return console_ui::ParseIntNoThrow(text, out) && *out >= 0;
+}
+
+bool ParseDifficulty(const std::string& name, sudoku::Difficulty* out) {
+  if (name == "easy") {
+    *out = sudoku::Difficulty::kEasy;
+  } else if (name == "medium") {
+    *out = sudoku::Difficulty::kMedium;
+  } else if (name == "hard") {
+    *out = sudoku::Difficulty::kHard;
+  } else if (name == "expert") {
+    *out = sudoku::Difficulty::kExpert;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseSymmetry(const std::string& name, sudoku::ClueSymmetry* out) {
+  if (name == "none") {
+    *out = sudoku::ClueSymmetry::kNone;
+  } else if (name == "rotational") {
+    *out = sudoku::ClueSymmetry::kRotational;
+  } else if (name == "quarter") {
+    *out = sudoku::ClueSymmetry::kQuarterTurn;
+  } else if (name == "mirror") {
+    *out = sudoku::ClueSymmetry::kMirror;
+  } else if (name == "diagonal") {
+    *out = sudoku::ClueSymmetry::kDiagonal;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Stats — BatchSolveStats или StoreBatchStats.
+template <typename Stats>
+void PrintThroughput(const char* verb, const Stats& stats) {
+  const double rate = stats.seconds > 0 ? stats.puzzles / stats.seconds : 0.0;
+  std::cerr << verb << " " << stats.puzzles << " задач за " << stats.seconds
+            << " с (" << rate << " задач/с)\n";
+}
+
+int Fail(const std::string& error) {
+  std::cerr << "Ошибка: " << error << "\n";
+  return 1;
+}
+
+int BadArgument(const std::string& message) {
+  std::cerr << message << "\n";
+  return 2;
+}
+
+int RunSolve(const CommandLine& args) {
+  sudoku::BatchSolveOptions options;
+  const std::string threads = args.Get("threads", 2, "0");
+  if (!ParseThreadCount(threads, &options.thread_count)) {
+    return BadArgument("Некорректное число потоков: " + threads);
+  }
+  const std::string engine = args.Get("engine", 3, "prop");
+  if (engine == "mrv") {
+    options.solve = &SolveMrv;
+  } else if (engine == "dlx") {
+    options.solve = &sudoku::SolveDlx;
+  } else if (engine != "prop") {
+    return BadArgument("Неизвестный решатель: " + engine);
+  }
+
+  sudoku::SolutionCache cache(kBatchCacheCapacity);
+  options.collect_stats = args.Has("stats");
+  if (args.Has("cache")) options.cache = &cache;
+  // Старый синтаксис: слова stats и cache после решателя.
+  for (std::size_t i = 4; i < args.positional().size(); ++i) {
+    const std::string& word = args.positional()[i];
+    if (word == "stats") {
+      options.collect_stats = true;
+    } else if (word == "cache") {
+      options.cache = &cache;
+    } else {
+      return BadArgument("Неизвестный параметр: " + word);
+    }
+  }
+
+  sudoku::BatchSolveStats stats;
+  std::string error;
+  if (!sudoku::SolveBatchFile(args.Get("in", 0, "-"), args.Get("out", 1, "-"),
+                              options, &stats, &error)) {
+    return Fail(error);
+  }
+
+  std::cerr << "Решено " << stats.solved << " из " << stats.puzzles << ". ";
+  PrintThroughput("Обработано", stats);
+  if (options.cache != nullptr) {
+    std::cerr << "Кэш решений: попаданий " << cache.hits() << ", промахов "
+              << cache.misses() << "\n";
+  }
+  if (options.collect_stats) {
+    sudoku::PrintSolveHistograms(stats.histograms, &std::cerr);
+  }
+  return 0;
+}
+
+int RunValidate(const CommandLine& args) {
+  sudoku::BatchSolveStats stats;
+  std::string error;
+  if (!sudoku::ValidateBatchFile(args.Get("in", 0, "-"),
+                                 args.Get("out", 1, "-"), &stats, &error)) {
+    return Fail(error);
+  }
+  std::cerr << "Корректных " << stats.solved << " из " << stats.puzzles
+            << ". ";
+  PrintThroughput("Проверено", stats);
+  return stats.solved == stats.puzzles ? 0 : 1;
+}
+
+int RunGenerate(const CommandLine& args) {
+  sudoku::BulkGenerateOptions options;
+  std::uint64_t count = 0;
+  const std::string count_text = args.Get("count", 0, "");
+  if (!ParseUint64(count_text, &count)) {
+    return BadArgument("Некорректное количество: " + count_text);
+  }
+
+  // Позиционно число удаляемых клеток и сложность стоят на одном месте.
+  const int targets = (args.IsSet("remove", 1) ? 1 : 0) +
+                      (args.Has("difficulty") ? 1 : 0) +
+                      (args.Has("minimal") ? 1 : 0) +
+                      (args.Has("solved") ? 1 : 0);
+  if (targets > 1) {
+    return BadArgument(
+        "Укажите только одно: --remove, --difficulty, --minimal или "
+        "--solved.");
+  }
+  if (args.Has("symmetry") && !args.Has("minimal")) {
+    return BadArgument("--symmetry задаётся только вместе с --minimal.");
+  }
+  if (args.Has("solved")) {
+    options.solved_grids = true;
+  } else if (args.Has("minimal")) {
+    options.minimal = true;
+    const std::string name =
+        args.Get("symmetry", CommandLine::kFlagOnly, "none");
+    if (!ParseSymmetry(name, &options.symmetry)) {
+      return BadArgument("Неизвестная симметрия: " + name);
+    }
+  } else if (args.Has("difficulty")) {
+    const std::string name = args.Get("difficulty", 1, "");
+    if (!ParseDifficulty(name, &options.difficulty)) {
+      return BadArgument("Неизвестная сложность: " + name);
+    }
+    options.use_difficulty = true;
+  } else {
+    const std::string remove = args.Get("remove", 1, "");
+    options.use_difficulty = ParseDifficulty(remove, &options.difficulty);
+    if (!options.use_difficulty &&
+        (!console_ui::ParseIntNoThrow(remove, &options.remove_count) ||
+         options.remove_count < 0 ||
+         options.remove_count > sudoku::SudokuGrid::kCellCount)) {
+      return BadArgument("Некорректное число удаляемых клеток: " + remove);
+    }
+  }
+
+  if (args.IsSet("seed", 2)) {
+    const std::string seed = args.Get("seed", 2, "");
+    if (!ParseUint64(seed, &options.seed)) {
+      return BadArgument("Некорректный seed: " + seed);
+    }
+  } else {
+    // Случайный seed печатается, чтобы набор можно было повторить.
+    std::random_device rd;
+    options.seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    std::cerr << "seed: " << options.seed << "\n";
+  }
+
+  const std::string threads = args.Get("threads", 4, "0");
+  if (!ParseThreadCount(threads, &options.thread_count)) {
+    return BadArgument("Некорректное число потоков: " + threads);
+  }
+
+  sudoku::BatchSolveStats stats;
+  std::string error;
+  if (!sudoku::GenerateBatchFile(options, count, args.Get("out", 3, "-"),
+                                 &stats, &error)) {
+    return Fail(error);
+  }
+  PrintThroughput("Сгенерировано", stats);
+  return 0;
+}
+
+int RunEnumerate(const CommandLine& args) {
+  std::uint64_t count = 0;
+  const std::string count_text =
+      args.Get("count", CommandLine::kFlagOnly, "0");
+  if (!ParseUint64(count_text, &count)) {
+    return BadArgument("Некорректное количество: " + count_text);
+  }
+
+  // Без --in перебираются все заполненные поля.
+  sudoku::SudokuGrid start;
+  if (args.Has("in")) {
+    const std::string path = args.Get("in", CommandLine::kFlagOnly, "-");
+    std::ifstream fin;
+    std::istream* in = &std::cin;
+    if (path != "-") {
+      fin.open(path, std::ios::binary);
+      if (!fin.is_open()) return Fail("не удалось открыть входной файл");
+      in = &fin;
+    }
+    sudoku::GridParser parser(in);
+    if (!parser.Next(&start)) {
+      return Fail(parser.ok() ? "во входе нет поля" : parser.error());
+    }
+  }
+
+  sudoku::BatchSolveStats stats;
+  std::string error;
+  if (!sudoku::EnumerateBatchFile(start, count,
+                                  args.Get("out", CommandLine::kFlagOnly, "-"),
+                                  &stats, &error)) {
+    return Fail(error);
+  }
+  PrintThroughput("Выведено", stats);
+  return 0;
+}
+
+int RunPack(const CommandLine& args) {
+  if (!args.IsSet("in", 0) || !args.IsSet("out", 1)) {
+    return BadArgument("Нужны входной и выходной файлы.");
+  }
+
+  std::uint64_t count = 0;
+  std::string error;
+  if (!sudoku::ConvertTextToCorpus(args.Get("in", 0, ""),
+                                   args.Get("out", 1, ""), &count, &error)) {
+    return Fail(error);
+  }
+  std::cerr << "Записано задач: " << count << "\n";
+  return 0;
+}
+
+int RunStore(const CommandLine& args) {
+  if (!args.Has("db")) {
+    return BadArgument("Нужен файл хранилища: --db <файл>.");
+  }
+  sudoku::StoreBatchOptions options;
+  options.solve = args.Has("solve");
+  options.check_only = args.Has("check");
+  if (options.solve && options.check_only) {
+    return BadArgument("--solve не сочетается с --check.");
+  }
+  const std::string threads = args.Get("threads", CommandLine::kFlagOnly, "0");
+  if (!ParseThreadCount(threads, &options.thread_count)) {
+    return BadArgument("Некорректное число потоков: " + threads);
+  }
+
+  sudoku::PuzzleStore store;
+  std::string error;
+  if (!store.Open(args.Get("db", CommandLine::kFlagOnly, ""),
+                  args.Has("canonical"), &error)) {
+    return Fail(error);
+  }
+  sudoku::StoreBatchStats stats;
+  if (!sudoku::StoreBatchFile(args.Get("in", CommandLine::kFlagOnly, "-"),
+                              args.Get("out", CommandLine::kFlagOnly, ""),
+                              &store, options, &stats, &error)) {
+    return Fail(error);
+  }
+  const std::size_t size = store.size();
+  if (!store.Close(&error)) return Fail(error);
+
+  std::cerr << (options.check_only ? "Новых " : "Добавлено ") << stats.added
+            << ", повторов " << stats.duplicates << ", некорректных "
+            << stats.invalid << "; в хранилище " << size << " задач. ";
+  PrintThroughput("Обработано", stats);
+  return 0;
+}
+
+int RunBench(const CommandLine& args) {
+  sudoku::BenchmarkOptions options;
+  options.corpus_dir = args.Get("corpus", 0, options.corpus_dir);
+  if (args.IsSet("easy", 1)) {
+    const std::string text = args.Get("easy", 1, "");
+    int easy = 0;
+    if (!console_ui::ParseIntNoThrow(text, &easy) || easy <= 0) {
+      return BadArgument("Некорректный размер набора: " + text);
+    }
+    options.easy_count = static_cast<std::size_t>(easy);
+  }
+
+  std::string error;
+  if (!sudoku::RunBenchmarks(options, &std::cout, &error)) {
+    return Fail(error);
+  }
+  return 0;
+}
+
+int RunHelp(const CommandLine& args);
+
+constexpr Command kCommands[] = {
+    {"solve",
+     "[--in <файл>] [--out <файл>] [--threads N] [--engine prop|mrv|dlx] "
+     "[--stats] [--cache]",
+     "in out threads engine", "stats cache", 6, &RunSolve},
+    {"batch", "— прежнее имя solve, те же аргументы",
+     "in out threads engine", "stats cache", 6, &RunSolve},
+    {"validate", "[--in <файл>] [--out <файл>]", "in out", "", 2,
+     &RunValidate},
+    {"generate",
+     "--count N (--remove K | --difficulty easy|medium|hard|expert | "
+     "--minimal [--symmetry none|rotational|quarter|mirror|diagonal] | "
+     "--solved) [--seed S] [--out <файл>] [--threads N]",
+     "count remove difficulty symmetry seed out threads", "minimal solved",
+     5, &RunGenerate},
+    {"enumerate", "[--in <файл с полем>] [--count N] [--out <файл>]",
+     "in count out", "", 0, &RunEnumerate},
+    {"pack", "--in <файл.txt> --out <файл.sdkc>", "in out", "", 2, &RunPack},
+    {"store",
+     "--db <файл> [--in <файл>] [--out <файл новых задач>] [--canonical] "
+     "[--solve | --check] [--threads N]",
+     "db in out threads", "canonical solve check", 0, &RunStore},
+    {"bench", "[--corpus <каталог>] [--easy N]", "corpus easy", "", 2,
+     &RunBench},
+    {"help", "", "", "", 0, &RunHelp},
+};
+
+const Command* FindCommand(const std::string& name) {
+  for (const Command& command : kCommands) {
+    if (name == command.name) return &command;
+  }
+  return nullptr;
+}
+
+void PrintUsage(const Command& command, std::ostream* out) {
+  *out << "  sudoku " << command.name;
+  if (command.usage[0] != '\0') *out << " " << command.usage;
+  *out << "\n";
+}
+
+int RunHelp(const CommandLine&) {
+  std::cout << "Использование (без аргументов — интерактивное меню):\n";
+  for (const Command& command : kCommands) PrintUsage(command, &std::cout);
+  std::cout << "Путь \"-\" — stdin/stdout (по умолчанию).\n";
+  return 0;
+}
+
+}  // namespace
+
+bool IsCommand(const std::string& name) {
+  return FindCommand(name) != nullptr;
+}
+
+int RunCommand(int argc, char* argv[]) {
+  const Command* command = argc > 1 ? FindCommand(argv[1]) : nullptr;
+  if (command == nullptr) return BadArgument("Неизвестная команда.");
+
+  // Меню здесь не работает: вывод только буферизованный.
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+
+  CommandLine args;
+  std::string error;
+  if (!args.Parse(*command, argc, argv, &error)) {
+    std::cerr << "Ошибка: " << error << "\nИспользование:\n";
+    PrintUsage(*command, &std::cerr);
+    return 2;
+  }
+  if (args.Has("help")) {
+    PrintUsage(*command, &std::cout);
+    return 0;
+  }
+  return command->run(args);
+}
+
+}  // namespace cli
@@ -0,0 +1,25 @@
+#ifndef SUDOKU_CLI_H_
+#define SUDOKU_CLI_H_
+
+#include <string>
+
+namespace cli {
+
+// Неинтерактивные подкоманды для скриптов и конвейеров: solve (batch),
+// validate, generate, enumerate, pack, store, bench, help. Аргументы — флаги
+// "--имя значение" или "--имя=значение"; прежний позиционный порядок тоже
+// принимается.
+// Ввод и вывод — файлы или stdin/stdout ("-"), по одному полю в компактном
+// формате на строку, без подсказок и с буферизованным выводом.
+
+// true, если name — имя подкоманды (иначе main запускает меню).
+bool IsCommand(const std::string& name);
+
+// Выполняет подкоманду argv[1]. Код возврата процесса: 0 — успех,
+// 1 — ошибка выполнения (для validate — и найденные некорректные поля),
+// 2 — неверные аргументы.
+int RunCommand(int argc, char* argv[]);
+
+}  // namespace cli
+
+#endif  // SUDOKU_CLI_H_
@@ -1,12 +1,12 @@
 #include "console_ui.h"
 
-#include <cctype>
 #include <iostream>
 #include <sstream>
 #include <string>
 
+#include "grid_parser.h"
+
 namespace console_ui {
-namespace {
 
 bool ParseIntNoThrow(const std::string& s, int* out) {
   if (out == nullptr) return false;
@@ -24,22 +24,6 @@ bool ParseIntNoThrow(const std::string& s, int* out) {
   return true;
 }
 
-bool CharToCellValue(char ch, int* value) {
-  if (value == nullptr) return false;
-
-  if (ch == '.' || ch == '0') {
-    *value = 0;
-    return true;
-  }
-  if (ch >= '1' && ch <= '9') {
-    *value = ch - '0';
-    return true;
-  }
-  return false;
-}
-
-}  // namespace
-
 bool ReadLine(const std::string& prompt, std::string* out) {
   if (out == nullptr) return false;
 
@@ -85,7 +69,7 @@ bool ReadGridFromStdin(sudoku::SudokuGrid* grid) {
 
     int c = 0;
     for (char ch : line) {
-      if (std::isspace(static_cast<unsigned char>(ch))) continue;
+      if (sudoku::IsGridSeparator(ch)) continue;
 
       if (c >= sudoku::SudokuGrid::kSize) {
         // Лишние значимые символы в строке.
@@ -93,7 +77,7 @@ bool ReadGridFromStdin(sudoku::SudokuGrid* grid) {
       }
 
       int v = 0;
-      if (!CharToCellValue(ch, &v)) return false;
+      if (!sudoku::CellCharToValue(ch, &v)) return false;
 
       tmp.Set(r, c, v);
       ++c;
@@ -7,6 +7,8 @@
 
 namespace console_ui {
 
+bool ParseIntNoThrow(const std::string& s, int* out);
+
 bool ReadLine(const std::string& prompt, std::string* out);
 bool ReadIntInRange(const std::string& prompt, int min_value, int max_value,
                     int* out);
@@ -0,0 +1,263 @@
+#include "corpus.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "grid_parser.h"
+
+namespace sudoku {
+namespace {
+
+constexpr char kMagic[8] = {'S', 'D', 'K', 'C', 'O', 'R', 'P', '1'};
+constexpr std::uint32_t kVersion = 1;
+
+void BuildHeader(std::uint64_t count, std::uint8_t* header) {
+  std::memset(header, 0, kCorpusHeaderSize);
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  PutLittleEndian(kVersion, 4, header + 8);
+  PutLittleEndian(kPackedGridSize, 4, header + 12);
+  PutLittleEndian(count, 8, header + 16);
+}
+
+}  // namespace
+
+void PutLittleEndian(std::uint64_t value, int bytes, std::uint8_t* out) {
+  for (int i = 0; i < bytes; ++i) {
+    out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+  }
+}
+
+std::uint64_t GetLittleEndian(const std::uint8_t* in, int bytes) {
+  std::uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+  }
+  return value;
+}
+
+void PackGrid(const SudokuGrid& grid, std::uint8_t* out) {
+  for (int k = 0; k < kPackedGridSize; ++k) {
+    const int lo = grid.GetCell(2 * k);
+    const int hi =
+        2 * k + 1 < SudokuGrid::kCellCount ? grid.GetCell(2 * k + 1) : 0;
+    out[k] = static_cast<std::uint8_t>(lo | (hi << 4));
+  }
+}
+
+bool UnpackGrid(const std::uint8_t* in, SudokuGrid* grid) {
+  if (in == nullptr || grid == nullptr) return false;
+
+  std::uint8_t cells[SudokuGrid::kCellCount];
+  UnpackCells(in, cells);
+  SudokuGrid tmp;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (cells[i] > SudokuGrid::kSize) return false;
+    tmp.SetCell(i, cells[i]);
+  }
+  *grid = tmp;
+  return true;
+}
+
+void UnpackCells(const std::uint8_t* in, std::uint8_t* cells) {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    cells[i] = static_cast<std::uint8_t>((in[i / 2] >> (4 * (i % 2))) & 0xF);
+  }
+}
+
+CorpusWriter::~CorpusWriter() {
+  if (out_.is_open()) Discard();
+}
+
+bool CorpusWriter::Open(const std::string& path, std::string* error) {
+  if (out_.is_open()) Discard();
+  path_ = path;
+  temp_path_ = path + ".tmp";
+  out_.open(temp_path_, std::ios::binary | std::ios::trunc);
+  if (!out_.is_open()) {
+    if (error) *error = "не удалось открыть файл на запись";
+    return false;
+  }
+  count_ = 0;
+
+  std::uint8_t header[kCorpusHeaderSize];
+  BuildHeader(0, header);
+  out_.write(reinterpret_cast<const char*>(header), kCorpusHeaderSize);
+  if (error) *error = "";
+  return out_.good();
+}
+
+bool CorpusWriter::Append(const SudokuGrid& grid) {
+  std::uint8_t record[kPackedGridSize];
+  PackGrid(grid, record);
+  out_.write(reinterpret_cast<const char*>(record), kPackedGridSize);
+  if (!out_.good()) return false;
+  ++count_;
+  return true;
+}
+
+bool CorpusWriter::Close(std::string* error) {
+  if (!out_.is_open()) {
+    if (error) *error = "файл не открыт";
+    return false;
+  }
+
+  std::uint8_t header[kCorpusHeaderSize];
+  BuildHeader(count_, header);
+  out_.seekp(0);
+  out_.write(reinterpret_cast<const char*>(header), kCorpusHeaderSize);
+  out_.close();
+  if (!out_.good()) {
+    std::remove(temp_path_.c_str());
+    if (error) *error = "ошибка записи в файл";
+    return false;
+  }
+
+  // filesystem::rename заменяет существующий файл и на Windows.
+  std::error_code rename_error;
+  std::filesystem::rename(temp_path_, path_, rename_error);
+  if (rename_error) {
+    std::remove(temp_path_.c_str());
+    if (error) *error = "не удалось переименовать временный файл корпуса";
+    return false;
+  }
+  if (error) *error = "";
+  return true;
+}
+
+void CorpusWriter::Discard() {
+  if (!out_.is_open()) return;
+  out_.close();
+  std::remove(temp_path_.c_str());
+}
+
+CorpusReader::~CorpusReader() {
+  Close();
+}
+
+bool CorpusReader::Open(const std::string& path, std::string* error) {
+  Close();
+
+#if defined(_WIN32)
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin.is_open()) {
+    if (error) *error = "не удалось открыть файл";
+    return false;
+  }
+  buffer_.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  length_ = buffer_.size();
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (error) *error = "не удалось открыть файл";
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    if (error) *error = "не удалось определить размер файла";
+    return false;
+  }
+  length_ = static_cast<std::size_t>(st.st_size);
+  void* mapped = length_ > 0
+                     ? ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0)
+                     : MAP_FAILED;
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    length_ = 0;
+    if (error) *error = "не удалось отобразить файл в память";
+    return false;
+  }
+  ::madvise(mapped, length_, MADV_SEQUENTIAL);
+  data_ = static_cast<const std::uint8_t*>(mapped);
+#endif
+
+  if (length_ < static_cast<std::size_t>(kCorpusHeaderSize) ||
+      std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 ||
+      GetLittleEndian(data_ + 8, 4) != kVersion ||
+      GetLittleEndian(data_ + 12, 4) != kPackedGridSize) {
+    Close();
+    if (error) *error = "файл не является корпусом задач";
+    return false;
+  }
+
+  const std::uint64_t count = GetLittleEndian(data_ + 16, 8);
+  const std::uint64_t available =
+      (length_ - kCorpusHeaderSize) / kPackedGridSize;
+  if (count > available) {
+    Close();
+    if (error) *error = "корпус обрезан: записей меньше, чем в заголовке";
+    return false;
+  }
+
+  records_ = data_ + kCorpusHeaderSize;
+  count_ = static_cast<std::size_t>(count);
+  if (error) *error = "";
+  return true;
+}
+
+void CorpusReader::Close() {
+#if !defined(_WIN32)
+  if (data_ != nullptr) {
+    ::munmap(const_cast<std::uint8_t*>(data_), length_);
+  }
+#endif
+  buffer_.clear();
+  data_ = nullptr;
+  length_ = 0;
+  records_ = nullptr;
+  count_ = 0;
+}
+
+bool IsCorpusFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::binary);
+  char magic[sizeof(kMagic)] = {};
+  fin.read(magic, sizeof(magic));
+  return fin.gcount() == static_cast<std::streamsize>(sizeof(magic)) &&
+         std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool ConvertTextToCorpus(const std::string& text_path,
+                         const std::string& corpus_path, std::uint64_t* count,
+                         std::string* error) {
+  std::ifstream fin(text_path, std::ios::binary);
+  if (!fin.is_open()) {
+    if (error) *error = "не удалось открыть входной файл";
+    return false;
+  }
+
+  // При любой ошибке ниже деструктор writer удаляет временный файл, а
+  // corpus_path не меняется.
+  CorpusWriter writer;
+  if (!writer.Open(corpus_path, error)) return false;
+
+  GridParser parser(&fin);
+  SudokuGrid grid;
+  while (parser.Next(&grid)) {
+    if (!writer.Append(grid)) {
+      if (error) *error = "ошибка записи в файл";
+      return false;
+    }
+  }
+  if (!parser.ok()) {
+    if (error) *error = parser.error();
+    return false;
+  }
+
+  if (count != nullptr) *count = writer.count();
+  return writer.Close(error);
+}
+
+}  // namespace sudoku
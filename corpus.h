@@ -0,0 +1,99 @@
+#ifndef SUDOKU_CORPUS_H_
+#define SUDOKU_CORPUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Двоичный корпус задач:
+//   заголовок 32 байта: "SDKCORP1", версия (u32), размер записи (u32),
+//   число записей (u64), резерв (u64); числа little-endian;
+//   далее записи по 41 байту: 81 клетка по 4 бита, клетка 2k — младшая
+//   тетрада байта k, клетка 2k+1 — старшая.
+constexpr int kPackedGridSize = (SudokuGrid::kCellCount + 1) / 2;
+constexpr int kCorpusHeaderSize = 32;
+
+// Числа заголовков двоичных файлов (корпус, puzzle_store.h): bytes младших
+// байтов value, little-endian.
+void PutLittleEndian(std::uint64_t value, int bytes, std::uint8_t* out);
+std::uint64_t GetLittleEndian(const std::uint8_t* in, int bytes);
+
+void PackGrid(const SudokuGrid& grid, std::uint8_t* out);
+// false, если в записи встретилось значение больше 9.
+bool UnpackGrid(const std::uint8_t* in, SudokuGrid* grid);
+// 81 тетрада записи в cells без проверки диапазона (0..15): сырой блок для
+// ValidateCellBlocks, значения больше 9 он отмечает сам.
+void UnpackCells(const std::uint8_t* in, std::uint8_t* cells);
+
+// Последовательная запись корпуса. Записи идут во временный файл
+// "<path>.tmp"; Close() записывает число записей в заголовок и
+// переименовывает его в path, так что недописанный корпус (ошибка
+// разбора, сбой) под именем path не появляется, а прежний файл остаётся
+// нетронутым. Без Close() (Discard() или деструктор) временный файл
+// удаляется.
+class CorpusWriter {
+ public:
+  CorpusWriter() = default;
+  ~CorpusWriter();
+  CorpusWriter(const CorpusWriter&) = delete;
+  CorpusWriter& operator=(const CorpusWriter&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+  bool Append(const SudokuGrid& grid);
+  bool Close(std::string* error);
+  void Discard();
+
+  std::uint64_t count() const { return count_; }
+
+ private:
+  std::ofstream out_;
+  std::string path_;
+  std::string temp_path_;
+  std::uint64_t count_ = 0;
+};
+
+// Чтение корпуса через mmap (на Windows — чтение файла целиком): записи
+// доступны по указателю без копирования, распаковывается только нужная.
+class CorpusReader {
+ public:
+  CorpusReader() = default;
+  ~CorpusReader();
+  CorpusReader(const CorpusReader&) = delete;
+  CorpusReader& operator=(const CorpusReader&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  std::size_t size() const { return count_; }
+  const std::uint8_t* Record(std::size_t index) const {
+    return records_ + index * kPackedGridSize;
+  }
+  bool Get(std::size_t index, SudokuGrid* grid) const {
+    return UnpackGrid(Record(index), grid);
+  }
+
+ private:
+  const std::uint8_t* data_ = nullptr;
+  std::size_t length_ = 0;
+  const std::uint8_t* records_ = nullptr;
+  std::size_t count_ = 0;
+  std::vector<std::uint8_t> buffer_;  // Только без mmap.
+};
+
+// true, если файл начинается с сигнатуры корпуса.
+bool IsCorpusFile(const std::string& path);
+
+// Текстовый файл (любой формат GridParser) -> корпус.
+bool ConvertTextToCorpus(const std::string& text_path,
+                         const std::string& corpus_path, std::uint64_t* count,
+                         std::string* error);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_CORPUS_H_
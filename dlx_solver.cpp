@@ -0,0 +1,156 @@
+#include "dlx_solver.h"
+
+namespace sudoku {
+namespace {
+
+constexpr int kHeader = 0;
+
+// Номер столбца-ограничения (начиная с 1, 0 — корневой заголовок).
+int ConstraintColumn(int kind, int cell, int digit) {
+  const int r = SudokuGrid::RowOf(cell);
+  const int c = SudokuGrid::ColOf(cell);
+  switch (kind) {
+    case 0:
+      return 1 + cell;
+    case 1:
+      return 1 + SudokuGrid::kCellCount + r * SudokuGrid::kSize + digit;
+    case 2:
+      return 1 + 2 * SudokuGrid::kCellCount + c * SudokuGrid::kSize + digit;
+    default:
+      return 1 + 3 * SudokuGrid::kCellCount +
+             SudokuGrid::BoxIndex(r, c) * SudokuGrid::kSize + digit;
+  }
+}
+
+}  // namespace
+
+DlxSolver::DlxSolver()
+    : left_{}, right_{}, up_{}, down_{}, column_{}, size_{}, stack_{} {
+  Reset();
+}
+
+void DlxSolver::Reset() {
+  for (int col = 0; col <= kColumns; ++col) {
+    left_[col] = col == 0 ? kColumns : col - 1;
+    right_[col] = col == kColumns ? kHeader : col + 1;
+    up_[col] = col;
+    down_[col] = col;
+    column_[col] = col;
+    size_[col] = 0;
+  }
+
+  // Строка row = cell * 9 + (цифра - 1) занимает 4 подряд идущих узла.
+  for (int row = 0; row < kRows; ++row) {
+    const int cell = row / SudokuGrid::kSize;
+    const int digit = row % SudokuGrid::kSize;
+    const int first = kFirstRowNode + row * 4;
+    for (int k = 0; k < 4; ++k) {
+      const int node = first + k;
+      const int col = ConstraintColumn(k, cell, digit);
+
+      left_[node] = k == 0 ? first + 3 : node - 1;
+      right_[node] = k == 3 ? first : node + 1;
+
+      column_[node] = col;
+      up_[node] = up_[col];
+      down_[node] = col;
+      down_[up_[col]] = node;
+      up_[col] = node;
+      ++size_[col];
+    }
+  }
+}
+
+void DlxSolver::Cover(int col) {
+  right_[left_[col]] = right_[col];
+  left_[right_[col]] = left_[col];
+  for (int i = down_[col]; i != col; i = down_[i]) {
+    for (int j = right_[i]; j != i; j = right_[j]) {
+      down_[up_[j]] = down_[j];
+      up_[down_[j]] = up_[j];
+      --size_[column_[j]];
+    }
+  }
+}
+
+void DlxSolver::Uncover(int col) {
+  for (int i = up_[col]; i != col; i = up_[i]) {
+    for (int j = left_[i]; j != i; j = left_[j]) {
+      ++size_[column_[j]];
+      down_[up_[j]] = j;
+      up_[down_[j]] = j;
+    }
+  }
+  right_[left_[col]] = col;
+  left_[right_[col]] = col;
+}
+
+bool DlxSolver::Solve(SudokuGrid* grid, SolveStats* stats) {
+  if (grid == nullptr) return false;
+  if (grid->HasConflicts()) return false;
+
+  ScopedSolveTimer timer(stats);
+  SolveStats local;
+  SolveStats* s = stats != nullptr ? stats : &local;
+  Reset();
+
+  // Подсказки: выбранная строка покрывает все свои 4 столбца.
+  for (int cell = 0; cell < SudokuGrid::kCellCount; ++cell) {
+    const int v = grid->GetCell(cell);
+    if (v == 0) continue;
+    const int first = kFirstRowNode + (cell * SudokuGrid::kSize + v - 1) * 4;
+    for (int k = 0; k < 4; ++k) Cover(column_[first + k]);
+  }
+
+  int level = 0;
+  int node = 0;
+  bool descend = true;
+
+  while (true) {
+    if (descend) {
+      if (right_[kHeader] == kHeader) break;
+
+      int best = right_[kHeader];
+      for (int col = right_[best]; col != kHeader; col = right_[col]) {
+        if (size_[col] < size_[best]) best = col;
+      }
+      Cover(best);
+      node = down_[best];
+      if (size_[best] == 1) ++s->propagation_hits;
+    }
+
+    if (node == column_[node]) {
+      // Варианты столбца исчерпаны — откат на уровень выше.
+      Uncover(node);
+      if (level == 0) return false;
+      --level;
+      ++s->backtracks;
+      node = stack_[level];
+      for (int j = left_[node]; j != node; j = left_[j]) Uncover(column_[j]);
+      node = down_[node];
+      descend = false;
+      continue;
+    }
+
+    stack_[level++] = node;
+    ++s->nodes;
+    if (level > s->max_depth) s->max_depth = level;
+    for (int j = right_[node]; j != node; j = right_[j]) Cover(column_[j]);
+    descend = true;
+  }
+
+  for (int i = 0; i < level; ++i) {
+    const int row = (stack_[i] - kFirstRowNode) / 4;
+    grid->SetCell(row / SudokuGrid::kSize, row % SudokuGrid::kSize + 1);
+  }
+  return true;
+}
+
+bool SolveDlx(SudokuGrid* grid) { return SolveDlx(grid, nullptr); }
+
+bool SolveDlx(SudokuGrid* grid, SolveStats* stats) {
+  thread_local DlxSolver solver;
+  return solver.Solve(grid, stats);
+}
+
+}  // namespace sudoku
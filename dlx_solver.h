@@ -0,0 +1,49 @@
+#ifndef SUDOKU_DLX_SOLVER_H_
+#define SUDOKU_DLX_SOLVER_H_
+
+#include <array>
+
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Dancing Links (алгоритм X Кнута): судоку как задача точного покрытия
+// 324 ограничений (клетка, строка-цифра, столбец-цифра, блок-цифра) строками
+// 729 вариантов «цифра в клетке». Все узлы лежат в одном пуле фиксированного
+// размера внутри объекта; перед каждой задачей связи переинициализируются,
+// так что решение не выделяет память. Поиск итеративный, с явным стеком.
+class DlxSolver {
+ public:
+  DlxSolver();
+
+  // stats (может быть nullptr): узлы — выбранные строки покрытия, откаты —
+  // снятые, вынужденные ходы — выбор из столбца с одной строкой.
+  bool Solve(SudokuGrid* grid, SolveStats* stats);
+
+ private:
+  static constexpr int kColumns = 4 * SudokuGrid::kCellCount;
+  static constexpr int kRows = SudokuGrid::kCellCount * SudokuGrid::kSize;
+  static constexpr int kFirstRowNode = kColumns + 1;
+  static constexpr int kNodes = kFirstRowNode + 4 * kRows;
+
+  void Reset();
+  void Cover(int col);
+  void Uncover(int col);
+
+  std::array<int, kNodes> left_;
+  std::array<int, kNodes> right_;
+  std::array<int, kNodes> up_;
+  std::array<int, kNodes> down_;
+  std::array<int, kNodes> column_;
+  std::array<int, kColumns + 1> size_;
+  std::array<int, SudokuGrid::kCellCount> stack_;
+};
+
+// Тот же интерфейс, что у SolveIterative; использует DlxSolver потока.
+bool SolveDlx(SudokuGrid* grid);
+bool SolveDlx(SudokuGrid* grid, SolveStats* stats);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_DLX_SOLVER_H_
@@ -1,30 +1,14 @@
 #include "file_io.h"
 
-#include <cctype>
 #include <fstream>
-#include <iterator>
 #include <string>
 
-namespace sudoku {
-namespace {
-
-bool CharToValue(char ch, int* value) {
-  if (value == nullptr) return false;
+#include "grid_parser.h"
 
-  if (ch == '.' || ch == '0') {
-    *value = 0;
-    return true;
-  }
-  if (ch >= '1' && ch <= '9') {
-    *value = ch - '0';
-    return true;
-  }
-  return false;
-}
-
-}  // namespace
+namespace sudoku {
 
-bool LoadGridFromFile(const std::string& path, SudokuGrid* grid,
+template <int kBox>
+bool LoadGridFromFile(const std::string& path, BasicSudokuGrid<kBox>* grid,
                       std::string* error) {
   if (grid == nullptr) {
     if (error) *error = "внутренняя ошибка: grid == nullptr";
@@ -37,40 +21,18 @@ bool LoadGridFromFile(const std::string& path, SudokuGrid* grid,
     return false;
   }
 
-  std::string content((std::istreambuf_iterator<char>(fin)),
-                      std::istreambuf_iterator<char>());
-
-  SudokuGrid tmp;
-  int count = 0;
-  int r = 0;
-  int c = 0;
-
-  for (char ch : content) {
-    if (std::isspace(static_cast<unsigned char>(ch))) continue;
-
-    if (count >= SudokuGrid::kCellCount) {
-      if (error) *error = "слишком много данных: нужно ровно 81 значение";
-      return false;
-    }
-
-    int v = 0;
-    if (!CharToValue(ch, &v)) {
-      if (error) *error = "некорректный символ в файле (разрешено: 1-9, 0, .)";
-      return false;
-    }
-
-    tmp.Set(r, c, v);
-    ++count;
-
-    ++c;
-    if (c == SudokuGrid::kSize) {
-      c = 0;
-      ++r;
-    }
+  BasicGridParser<kBox> parser(&fin);
+  parser.set_free_layout(true);
+  BasicSudokuGrid<kBox> tmp;
+  if (!parser.Next(&tmp)) {
+    if (error) *error = parser.ok() ? "в файле нет поля" : parser.error();
+    return false;
   }
-
-  if (count != SudokuGrid::kCellCount) {
-    if (error) *error = "недостаточно данных: нужно ровно 81 значение";
+  BasicSudokuGrid<kBox> extra;
+  if (parser.Next(&extra) || !parser.ok()) {
+    if (error) {
+      *error = parser.ok() ? "в файле больше одного поля" : parser.error();
+    }
     return false;
   }
 
@@ -79,19 +41,21 @@ bool LoadGridFromFile(const std::string& path, SudokuGrid* grid,
   return true;
 }
 
-bool SaveGridToFile(const std::string& path, const SudokuGrid& grid,
-                    std::string* error) {
+template <int kBox>
+bool SaveGridToFile(const std::string& path,
+                    const BasicSudokuGrid<kBox>& grid, std::string* error) {
+  using Grid = BasicSudokuGrid<kBox>;
+
   std::ofstream fout(path);
   if (!fout.is_open()) {
     if (error) *error = "не удалось открыть файл на запись";
     return false;
   }
 
-  for (int r = 0; r < SudokuGrid::kSize; ++r) {
-    for (int c = 0; c < SudokuGrid::kSize; ++c) {
-      const int v = grid.Get(r, c);
-      fout << (v == 0 ? '.' : static_cast<char>('0' + v));
-      if (c + 1 != SudokuGrid::kSize) fout << ' ';
+  for (int r = 0; r < Grid::kSize; ++r) {
+    for (int c = 0; c < Grid::kSize; ++c) {
+      fout << ValueToChar(grid.Get(r, c));
+      if (c + 1 != Grid::kSize) fout << ' ';
     }
     fout << '\n';
   }
@@ -105,4 +69,44 @@ bool SaveGridToFile(const std::string& path, const SudokuGrid& grid,
   return true;
 }
 
+template <int kBox>
+bool LoadGrids(const std::string& path,
+               std::vector<BasicSudokuGrid<kBox>>* grids, std::string* error) {
+  if (grids == nullptr) {
+    if (error) *error = "внутренняя ошибка: grids == nullptr";
+    return false;
+  }
+
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin.is_open()) {
+    if (error) *error = "не удалось открыть файл";
+    return false;
+  }
+
+  grids->clear();
+  BasicGridParser<kBox> parser(&fin);
+  BasicSudokuGrid<kBox> grid;
+  while (parser.Next(&grid)) grids->push_back(grid);
+  if (!parser.ok()) {
+    if (error) *error = parser.error();
+    return false;
+  }
+
+  if (error) *error = "";
+  return true;
+}
+
+#define SUDOKU_INSTANTIATE_FILE_IO(B)                                     \
+  template bool LoadGridFromFile<B>(const std::string& path,              \
+                                    BasicSudokuGrid<B>* grid,             \
+                                    std::string* error);                  \
+  template bool SaveGridToFile<B>(const std::string& path,                \
+                                  const BasicSudokuGrid<B>& grid,         \
+                                  std::string* error);                    \
+  template bool LoadGrids<B>(const std::string& path,                     \
+                             std::vector<BasicSudokuGrid<B>>* grids,      \
+                             std::string* error);
+SUDOKU_FOR_EACH_BOX_SIZE(SUDOKU_INSTANTIATE_FILE_IO)
+#undef SUDOKU_INSTANTIATE_FILE_IO
+
 }  // namespace sudoku
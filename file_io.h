@@ -2,15 +2,29 @@
 #define SUDOKU_FILE_IO_H_
 
 #include <string>
+#include <vector>
 
 #include "sudoku_grid.h"
 
 namespace sudoku {
 
-bool LoadGridFromFile(const std::string& path, SudokuGrid* grid,
+// Все функции — шаблоны по размеру блока; размер поля задаётся типом
+// grid (SudokuGrid — 9×9).
+
+// Файл с ровно одним полем: N² клеток в любой раскладке по строкам и
+// пробелам (GridParser в режиме set_free_layout), рамка и комментарии
+// допускаются.
+template <int kBox>
+bool LoadGridFromFile(const std::string& path, BasicSudokuGrid<kBox>* grid,
                       std::string* error);
-bool SaveGridToFile(const std::string& path, const SudokuGrid& grid,
-                    std::string* error);
+template <int kBox>
+bool SaveGridToFile(const std::string& path,
+                    const BasicSudokuGrid<kBox>& grid, std::string* error);
+
+// Все поля файла; форматы можно смешивать (см. GridParser).
+template <int kBox>
+bool LoadGrids(const std::string& path,
+               std::vector<BasicSudokuGrid<kBox>>* grids, std::string* error);
 
 }  // namespace sudoku
 
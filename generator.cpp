@@ -5,55 +5,294 @@
 #include <numeric>
 #include <vector>
 
+#include "bits.h"
+#include "parallel.h"
+#include "propagation.h"
 #include "solver.h"
 
 namespace sudoku {
 namespace {
 
+// Базовое корректное поле: строка r — сдвиг первой строки на
+// r * kBox + r / kBox позиций.
+template <int kBox>
 int Pattern(int r, int c) {
-  return (r * 3 + r / 3 + c) % 9;
+  constexpr int kSize = kBox * kBox;
+  return (r * kBox + r / kBox + c) % kSize;
 }
 
-template <typename T>
-void Shuffle(std::vector<T>* v, std::mt19937* rng) {
-  std::shuffle(v->begin(), v->end(), *rng);
-}
-
-std::vector<int> ShuffledIndicesByGroups(int group_count, int group_size,
-                                         std::mt19937* rng) {
-  std::vector<int> groups(group_count);
+// Перестановка 0..kSize-1, сохраняющая группы по kBox подряд: переставлены
+// сами группы и индексы внутри каждой. Массив фиксированного размера — без
+// выделений памяти.
+template <int kBox>
+std::array<int, kBox * kBox> ShuffledIndicesByGroups(std::mt19937* rng) {
+  std::array<int, kBox> groups;
   std::iota(groups.begin(), groups.end(), 0);
-  Shuffle(&groups, rng);
+  std::shuffle(groups.begin(), groups.end(), *rng);
 
-  std::vector<int> result;
-  result.reserve(group_count * group_size);
-  for (int g : groups) {
-    std::vector<int> inner(group_size);
+  std::array<int, kBox * kBox> result;
+  for (int g = 0; g < kBox; ++g) {
+    std::array<int, kBox> inner;
     std::iota(inner.begin(), inner.end(), 0);
-    Shuffle(&inner, rng);
-    for (int x : inner) {
-      result.push_back(g * group_size + x);
+    std::shuffle(inner.begin(), inner.end(), *rng);
+    for (int k = 0; k < kBox; ++k) {
+      result[g * kBox + k] = groups[g] * kBox + inner[k];
     }
   }
   return result;
 }
 
+std::uint64_t SplitMix64(std::uint64_t* state) {
+  std::uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Начальное состояние потока ГСЧ задачи номер index.
+std::uint64_t PuzzleSeed(std::uint64_t seed, std::uint64_t index) {
+  return seed ^ SplitMix64(&index);
+}
+
+// Заполняет всё состояние mt19937 словами SplitMix64. std::seed_seq
+// перемешивает 624 слова десятки микросекунд — дольше, чем строится само
+// поле; здесь это почти бесплатно, а разные начальные состояния по-прежнему
+// дают независимые потоки.
+class SplitMixSeedSeq {
+ public:
+  using result_type = std::uint32_t;
+
+  explicit SplitMixSeedSeq(std::uint64_t state) : state_(state) {}
+
+  template <typename It>
+  void generate(It begin, It end) {
+    for (; begin != end; ++begin) {
+      *begin = static_cast<result_type>(SplitMix64(&state_) >> 32);
+    }
+  }
+
+ private:
+  std::uint64_t state_;
+};
+
+// До удаления клетки idx решение было единственным. Любое другое решение
+// новой задачи было бы решением и старой, если бы совпадало с ней в idx,
+// поэтому достаточно проверить, решается ли задача с другой цифрой в idx.
+template <int kBox>
+bool HasOtherValue(const BasicSudokuGrid<kBox>& puzzle, int idx, int old) {
+  unsigned others = puzzle.CandidateMask(idx) & ~(1u << old);
+  for (; others != 0; others &= others - 1) {
+    BasicSudokuGrid<kBox> attempt = puzzle;
+    attempt.SetCell(idx, LowestBit(others));
+    if constexpr (kBox == 3) {
+      if (SolveWithPropagation(&attempt, nullptr)) return true;
+    } else {
+      if (SolveIterative(&attempt, CellOrder::kMinRemaining)) return true;
+    }
+  }
+  return false;
+}
+
+// Орбита клетки index при симметрии: сама клетка и её образы, без
+// повторов. Возвращает число клеток в cells.
+template <int kBox>
+int SymmetricCells(int index, ClueSymmetry symmetry,
+                   std::array<int, 4>* cells) {
+  using Grid = BasicSudokuGrid<kBox>;
+  const int r = Grid::RowOf(index);
+  const int c = Grid::ColOf(index);
+  const int last = Grid::kSize - 1;
+
+  std::array<int, 4> images = {index, index, index, index};
+  switch (symmetry) {
+    case ClueSymmetry::kNone:
+      break;
+    case ClueSymmetry::kRotational:
+      images[1] = (last - r) * Grid::kSize + (last - c);
+      break;
+    case ClueSymmetry::kQuarterTurn:
+      images[1] = c * Grid::kSize + (last - r);
+      images[2] = (last - r) * Grid::kSize + (last - c);
+      images[3] = (last - c) * Grid::kSize + r;
+      break;
+    case ClueSymmetry::kMirror:
+      images[1] = r * Grid::kSize + (last - c);
+      break;
+    case ClueSymmetry::kDiagonal:
+      images[1] = c * Grid::kSize + r;
+      break;
+  }
+
+  int count = 0;
+  for (int cell : images) {
+    bool seen = false;
+    for (int k = 0; k < count; ++k) seen = seen || (*cells)[k] == cell;
+    if (!seen) (*cells)[count++] = cell;
+  }
+  return count;
+}
+
+// Случайное число из [0, n): умножение со сдвигом вместо деления
+// (смещение порядка n / 2^32 для генерации полей несущественно).
+template <typename Rng>
+unsigned RandomBelow(unsigned n, Rng* rng) {
+  return static_cast<unsigned>(
+      (static_cast<std::uint64_t>((*rng)()) * n) >> 32);
+}
+
+// Случайная цифра из непустой маски кандидатов.
+template <typename Rng>
+int RandomBit(unsigned mask, Rng* rng) {
+  for (unsigned k = RandomBelow(PopCount(mask), rng); k > 0; --k) {
+    mask &= mask - 1;
+  }
+  return LowestBit(mask);
+}
+
+// Строка, столбец и блок клетки 9×9 — таблицей, без деления в горячем
+// цикле GenerateRandomSolvedGrid.
+struct CellUnits {
+  std::array<std::uint8_t, SudokuGrid::kCellCount> row;
+  std::array<std::uint8_t, SudokuGrid::kCellCount> col;
+  std::array<std::uint8_t, SudokuGrid::kCellCount> box;
+};
+
+const CellUnits& CellUnitTable() {
+  static const CellUnits table = [] {
+    CellUnits t{};
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+      t.row[i] = static_cast<std::uint8_t>(SudokuGrid::RowOf(i));
+      t.col[i] = static_cast<std::uint8_t>(SudokuGrid::ColOf(i));
+      t.box[i] = static_cast<std::uint8_t>(SudokuGrid::BoxOf(i));
+    }
+    return t;
+  }();
+  return table;
+}
+
 }  // namespace
 
-SudokuGrid GenerateSolvedGrid(std::mt19937* rng) {
+SplitMixRng::result_type SplitMixRng::operator()() {
+  return static_cast<result_type>(SplitMix64(&state_) >> 32);
+}
+
+template <typename Rng>
+SudokuGrid GenerateRandomSolvedGrid(Rng* rng) {
   SudokuGrid grid;
   if (rng == nullptr) return grid;
 
-  std::vector<int> rows = ShuffledIndicesByGroups(3, 3, rng);
-  std::vector<int> cols = ShuffledIndicesByGroups(3, 3, rng);
+  std::array<std::uint8_t, SudokuGrid::kCellCount> cells{};
+  std::array<unsigned, SudokuGrid::kSize> rows{};
+  std::array<unsigned, SudokuGrid::kSize> cols{};
+  std::array<unsigned, SudokuGrid::kSize> boxes{};
+  const CellUnits& at = CellUnitTable();
+  const auto toggle = [&](int i, int v) {
+    const unsigned bit = 1u << v;
+    rows[at.row[i]] ^= bit;
+    cols[at.col[i]] ^= bit;
+    boxes[at.box[i]] ^= bit;
+  };
+
+  const UnitCellTable& units = UnitCells();
+  std::array<int, SudokuGrid::kSize> digits{};
+  std::iota(digits.begin(), digits.end(), 1);
+  for (int b = 0; b < SudokuGrid::kSize; b += SudokuGrid::kBoxSize + 1) {
+    for (int k = SudokuGrid::kSize - 1; k > 0; --k) {
+      std::swap(digits[k], digits[RandomBelow(k + 1, rng)]);
+    }
+    for (int k = 0; k < SudokuGrid::kSize; ++k) {
+      const int i = units[2 * SudokuGrid::kSize + b][k];
+      cells[i] = static_cast<std::uint8_t>(digits[k]);
+      toggle(i, digits[k]);
+    }
+  }
+
+  // Пустые клетки в начале empty; снятая с поля клетка переносится в конец
+  // живой части, поэтому при откате (в обратном порядке) она возвращается
+  // простым ++empty_count.
+  std::array<std::uint8_t, SudokuGrid::kCellCount> empty;
+  int empty_count = 0;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (cells[i] == 0) empty[empty_count++] = static_cast<std::uint8_t>(i);
+  }
+
+  // Стек ходов: клетка и ещё не испробованные цифры.
+  struct Frame {
+    int cell;
+    unsigned rest;
+  };
+  std::array<Frame, SudokuGrid::kCellCount> stack;
+  int depth = 0;
+  while (empty_count > 0) {
+    int best = -1;
+    unsigned best_mask = 0;
+    int best_count = SudokuGrid::kSize + 1;
+    for (int k = 0; k < empty_count; ++k) {
+      const int i = empty[k];
+      const unsigned mask =
+          ~(rows[at.row[i]] | cols[at.col[i]] | boxes[at.box[i]]) &
+          SudokuGrid::kAllDigits;
+      const int n = PopCount(mask);
+      if (n < best_count) {
+        best = k;
+        best_mask = mask;
+        best_count = n;
+        if (n <= 1) break;
+      }
+    }
 
-  std::array<int, 9> digits{};
-  for (int i = 0; i < 9; ++i) digits[i] = i + 1;
+    if (best_count > 0) {
+      const int cell = empty[best];
+      empty[best] = empty[--empty_count];
+      empty[empty_count] = static_cast<std::uint8_t>(cell);
+      const int v = RandomBit(best_mask, rng);
+      stack[depth++] = {cell, best_mask & ~(1u << v)};
+      cells[cell] = static_cast<std::uint8_t>(v);
+      toggle(cell, v);
+      continue;
+    }
+
+    // Тупик: снимаем ходы, пока у какого-то не найдётся другая цифра.
+    // Диагональные блоки дополняются до поля всегда, так что стек не
+    // опустеет.
+    while (depth > 0) {
+      Frame& top = stack[depth - 1];
+      toggle(top.cell, cells[top.cell]);
+      if (top.rest == 0) {
+        cells[top.cell] = 0;
+        ++empty_count;
+        --depth;
+        continue;
+      }
+      const int v = RandomBit(top.rest, rng);
+      top.rest &= ~(1u << v);
+      cells[top.cell] = static_cast<std::uint8_t>(v);
+      toggle(top.cell, v);
+      break;
+    }
+  }
+
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) grid.SetCell(i, cells[i]);
+  return grid;
+}
+
+template <int kBox>
+BasicSudokuGrid<kBox> GenerateSolvedGrid(std::mt19937* rng) {
+  using Grid = BasicSudokuGrid<kBox>;
+
+  Grid grid;
+  if (rng == nullptr) return grid;
+
+  const std::array<int, Grid::kSize> rows = ShuffledIndicesByGroups<kBox>(rng);
+  const std::array<int, Grid::kSize> cols = ShuffledIndicesByGroups<kBox>(rng);
+
+  std::array<int, Grid::kSize> digits{};
+  for (int i = 0; i < Grid::kSize; ++i) digits[i] = i + 1;
   std::shuffle(digits.begin(), digits.end(), *rng);
 
-  for (int r = 0; r < SudokuGrid::kSize; ++r) {
-    for (int c = 0; c < SudokuGrid::kSize; ++c) {
-      const int base = Pattern(rows[r], cols[c]);
+  for (int r = 0; r < Grid::kSize; ++r) {
+    for (int c = 0; c < Grid::kSize; ++c) {
+      const int base = Pattern<kBox>(rows[r], cols[c]);
       grid.Set(r, c, digits[base]);
     }
   }
@@ -63,41 +302,61 @@ SudokuGrid GenerateSolvedGrid(std::mt19937* rng) {
 SudokuGrid CreatePuzzle(const SudokuGrid& solved, int remove_count,
                         bool ensure_solvable, std::mt19937* rng,
                         int* removed_out) {
+  return CreatePuzzle(solved, remove_count,
+                      ensure_solvable ? PuzzleCheck::kSolvable : PuzzleCheck::kNone,
+                      rng, removed_out);
+}
+
+template <int kBox>
+BasicSudokuGrid<kBox> CreatePuzzle(const BasicSudokuGrid<kBox>& solved,
+                                   int remove_count, PuzzleCheck check,
+                                   std::mt19937* rng, int* removed_out) {
+  using Grid = BasicSudokuGrid<kBox>;
+
   if (removed_out != nullptr) *removed_out = 0;
   if (rng == nullptr) return solved;
 
-  SudokuGrid puzzle = solved;
+  Grid puzzle = solved;
 
-  std::vector<int> positions(SudokuGrid::kCellCount);
+  // Из корректного полного поля удаление клеток не может сделать задачу
+  // нерешаемой, а её решение заведомо единственно — это позволяет проверять
+  // каждое удаление инкрементально, а не решать задачу заново.
+  const bool from_solution = solved.IsComplete() && !solved.HasConflicts();
+  if (check == PuzzleCheck::kSolvable && from_solution) {
+    check = PuzzleCheck::kNone;
+  }
+
+  std::array<int, Grid::kCellCount> positions;
   std::iota(positions.begin(), positions.end(), 0);
   std::shuffle(positions.begin(), positions.end(), *rng);
 
   int removed = 0;
   int attempts = 0;
   constexpr int kMaxAttemptsMultiplier = 5;
-  const int max_attempts = SudokuGrid::kCellCount * kMaxAttemptsMultiplier;
+  const int max_attempts = Grid::kCellCount * kMaxAttemptsMultiplier;
 
   for (int idx : positions) {
     if (removed >= remove_count) break;
 
-    const int r = idx / SudokuGrid::kSize;
-    const int c = idx % SudokuGrid::kSize;
-
-    const int old = puzzle.Get(r, c);
+    const int old = puzzle.GetCell(idx);
     if (old == 0) continue;
 
-    puzzle.Set(r, c, 0);
+    puzzle.SetCell(idx, 0);
 
-    if (!ensure_solvable) {
-      ++removed;
-      continue;
+    bool keep = true;
+    if (check == PuzzleCheck::kSolvable) {
+      // Копия дешёвая: маски копируются вместе с клетками, пересчёт не нужен.
+      Grid check_grid = puzzle;
+      keep = SolveIterative(&check_grid, CellOrder::kMinRemaining);
+    } else if (check == PuzzleCheck::kUnique) {
+      keep = from_solution ? !HasOtherValue(puzzle, idx, old)
+                           : CountSolutions(puzzle, 2) == 1;
     }
 
-    SudokuGrid check = puzzle;
-    if (SolveIterative(&check)) {
+    if (keep) {
       ++removed;
     } else {
-      puzzle.Set(r, c, old);
+      puzzle.SetCell(idx, old);
       ++attempts;
       if (attempts >= max_attempts) break;
     }
@@ -107,4 +366,139 @@ SudokuGrid CreatePuzzle(const SudokuGrid& solved, int remove_count,
   return puzzle;
 }
 
+SudokuGrid CreatePuzzle(const SudokuGrid& solved, Difficulty target,
+                        std::mt19937* rng, GradeResult* grade_out) {
+  GradeResult grade;
+  GradePuzzle(solved, &grade);
+  if (rng == nullptr || !solved.IsComplete() || solved.HasConflicts()) {
+    if (grade_out != nullptr) *grade_out = grade;
+    return solved;
+  }
+
+  SudokuGrid puzzle = solved;
+
+  std::array<int, SudokuGrid::kCellCount> positions;
+  std::iota(positions.begin(), positions.end(), 0);
+  std::shuffle(positions.begin(), positions.end(), *rng);
+
+  // Удаление клеток почти всегда только усложняет задачу, поэтому жадно
+  // удаляем всё, что сохраняет единственность и не выводит за target.
+  for (int idx : positions) {
+    const int old = puzzle.GetCell(idx);
+    puzzle.SetCell(idx, 0);
+
+    GradeResult candidate;
+    if (HasOtherValue(puzzle, idx, old) || !GradePuzzle(puzzle, &candidate) ||
+        candidate.difficulty > target) {
+      puzzle.SetCell(idx, old);
+      continue;
+    }
+    grade = candidate;
+  }
+
+  if (grade_out != nullptr) *grade_out = grade;
+  return puzzle;
+}
+
+template <int kBox>
+BasicSudokuGrid<kBox> CreateMinimalPuzzle(const BasicSudokuGrid<kBox>& solved,
+                                          ClueSymmetry symmetry,
+                                          std::mt19937* rng) {
+  using Grid = BasicSudokuGrid<kBox>;
+  if (rng == nullptr || !solved.IsComplete() || solved.HasConflicts()) {
+    return solved;
+  }
+
+  std::array<std::array<int, 4>, Grid::kCellCount> orbits;
+  std::array<int, Grid::kCellCount> orbit_sizes{};
+  std::array<bool, Grid::kCellCount> covered{};
+  int orbit_count = 0;
+  for (int i = 0; i < Grid::kCellCount; ++i) {
+    if (covered[i]) continue;
+    const int n = SymmetricCells<kBox>(i, symmetry, &orbits[orbit_count]);
+    for (int k = 0; k < n; ++k) covered[orbits[orbit_count][k]] = true;
+    orbit_sizes[orbit_count++] = n;
+  }
+
+  std::array<int, Grid::kCellCount> order;
+  std::iota(order.begin(), order.begin() + orbit_count, 0);
+  std::shuffle(order.begin(), order.begin() + orbit_count, *rng);
+
+  Grid puzzle = solved;
+  for (int k = 0; k < orbit_count; ++k) {
+    const std::array<int, 4>& cells = orbits[order[k]];
+    const int n = orbit_sizes[order[k]];
+    for (int j = 0; j < n; ++j) puzzle.SetCell(cells[j], 0);
+
+    // До удаления решение было единственным, поэтому любое другое решение
+    // отличается от solved в одной из клеток орбиты.
+    bool unique = true;
+    for (int j = 0; j < n && unique; ++j) {
+      unique = !HasOtherValue(puzzle, cells[j], solved.GetCell(cells[j]));
+    }
+
+    if (!unique) {
+      for (int j = 0; j < n; ++j) {
+        puzzle.SetCell(cells[j], solved.GetCell(cells[j]));
+      }
+    }
+  }
+  return puzzle;
+}
+
+template SudokuGrid GenerateRandomSolvedGrid(std::mt19937* rng);
+template SudokuGrid GenerateRandomSolvedGrid(SplitMixRng* rng);
+
+std::mt19937 PuzzleRng(std::uint64_t seed, std::uint64_t index) {
+  SplitMixSeedSeq seq(PuzzleSeed(seed, index));
+  return std::mt19937(seq);
+}
+
+void GeneratePuzzles(const BulkGenerateOptions& options, std::uint64_t first,
+                     std::size_t count, std::vector<SudokuGrid>* puzzles) {
+  if (puzzles == nullptr) return;
+  puzzles->resize(count);
+
+  ParallelFor(count, options.thread_count, [&](std::size_t i) {
+    if (options.solved_grids) {
+      SplitMixRng rng(PuzzleSeed(options.seed, first + i));
+      (*puzzles)[i] = GenerateRandomSolvedGrid(&rng);
+      return;
+    }
+    std::mt19937 rng = PuzzleRng(options.seed, first + i);
+    const SudokuGrid solved = GenerateRandomSolvedGrid(&rng);
+    if (options.minimal) {
+      (*puzzles)[i] = CreateMinimalPuzzle(solved, options.symmetry, &rng);
+      return;
+    }
+    if (!options.use_difficulty) {
+      (*puzzles)[i] = CreatePuzzle(solved, options.remove_count, options.check,
+                                   &rng, nullptr);
+      return;
+    }
+
+    // Полосы сложнее kMedium достигаются не с каждого поля; несколько
+    // попыток из того же потока ГСЧ сохраняют воспроизводимость.
+    constexpr int kDifficultyAttempts = 8;
+    for (int attempt = 0; attempt < kDifficultyAttempts; ++attempt) {
+      GradeResult grade;
+      (*puzzles)[i] = CreatePuzzle(
+          attempt == 0 ? solved : GenerateRandomSolvedGrid(&rng),
+          options.difficulty, &rng, &grade);
+      if (grade.difficulty == options.difficulty) break;
+    }
+  });
+}
+
+#define SUDOKU_INSTANTIATE_GENERATOR(B)                                   \
+  template BasicSudokuGrid<B> GenerateSolvedGrid<B>(std::mt19937* rng);   \
+  template BasicSudokuGrid<B> CreatePuzzle<B>(                            \
+      const BasicSudokuGrid<B>& solved, int remove_count,                 \
+      PuzzleCheck check, std::mt19937* rng, int* removed_out);            \
+  template BasicSudokuGrid<B> CreateMinimalPuzzle<B>(                     \
+      const BasicSudokuGrid<B>& solved, ClueSymmetry symmetry,            \
+      std::mt19937* rng);
+SUDOKU_FOR_EACH_BOX_SIZE(SUDOKU_INSTANTIATE_GENERATOR)
+#undef SUDOKU_INSTANTIATE_GENERATOR
+
 }  // namespace sudoku
@@ -1,13 +1,55 @@
 #ifndef SUDOKU_GENERATOR_H_
 #define SUDOKU_GENERATOR_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <random>
+#include <vector>
 
+#include "grader.h"
 #include "sudoku_grid.h"
 
 namespace sudoku {
 
-SudokuGrid GenerateSolvedGrid(std::mt19937* rng);
+// Заполненное корректное поле: перестановки строк и столбцов внутри полос,
+// самих полос и цифр применяются к базовому шаблону. Без аргумента
+// шаблона — 9×9, иначе GenerateSolvedGrid<4>(&rng) и т. п.
+template <int kBox = 3>
+BasicSudokuGrid<kBox> GenerateSolvedGrid(std::mt19937* rng);
+
+// Лёгкий ГСЧ (SplitMix64, 8 байт состояния) для массовой генерации полей:
+// создание std::mt19937 на каждое поле (заполнение и первое перемешивание
+// 624 слов) обходится дороже, чем построение самого поля.
+class SplitMixRng {
+ public:
+  using result_type = std::uint32_t;
+
+  explicit SplitMixRng(std::uint64_t seed) : state_(seed) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return 0xFFFFFFFFu; }
+  result_type operator()();
+
+ private:
+  std::uint64_t state_;
+};
+
+// Заполненное поле 9×9 случайным поиском: диагональные блоки (они не
+// зависят друг от друга) заполняются случайными перестановками, остальные
+// клетки — перебором MRV со случайным выбором цифры и откатами. В отличие
+// от GenerateSolvedGrid, который лишь переставляет один шаблон, так
+// достижимо любое корректное поле (распределение не строго равномерное).
+// Несколько микросекунд на поле, без выделений памяти. Rng — std::mt19937
+// или SplitMixRng.
+template <typename Rng>
+SudokuGrid GenerateRandomSolvedGrid(Rng* rng);
+
+// Что проверять после каждого удаления клетки в CreatePuzzle.
+enum class PuzzleCheck {
+  kNone,      // Без проверок.
+  kSolvable,  // Задача должна оставаться решаемой.
+  kUnique,    // Решение должно оставаться единственным.
+};
 
 // remove_count: сколько клеток сделать пустыми.
 // ensure_solvable: если true — удаление откатывается, если поле стало нерешаемым.
@@ -15,6 +57,63 @@ SudokuGrid GenerateSolvedGrid(std::mt19937* rng);
 SudokuGrid CreatePuzzle(const SudokuGrid& solved, int remove_count,
                         bool ensure_solvable, std::mt19937* rng,
                         int* removed_out);
+// Любой размер поля; для 9×9 проверка единственности использует
+// распространение ограничений, для остальных — MRV-перебор.
+template <int kBox>
+BasicSudokuGrid<kBox> CreatePuzzle(const BasicSudokuGrid<kBox>& solved,
+                                   int remove_count, PuzzleCheck check,
+                                   std::mt19937* rng, int* removed_out);
+
+// Задача с единственным решением в заданной полосе сложности: клетки
+// удаляются, пока это не делает задачу сложнее target. grade_out (может быть
+// nullptr) — оценка результата; цель достигнута, если её difficulty == target.
+// solved должно быть корректным заполненным полем.
+SudokuGrid CreatePuzzle(const SudokuGrid& solved, Difficulty target,
+                        std::mt19937* rng, GradeResult* grade_out);
+
+// Симметрия рисунка подсказок минимальной задачи.
+enum class ClueSymmetry {
+  kNone,
+  kRotational,   // Поворот на 180°.
+  kQuarterTurn,  // Повороты на 90°.
+  kMirror,       // Отражение слева направо.
+  kDiagonal,     // Отражение относительно главной диагонали.
+};
+
+// Минимальная задача: подсказки удаляются в случайном порядке (вместе с
+// симметричными им клетками), пока решение единственно. Удаление,
+// сломавшее единственность, позже тоже не пройдёт, поэтому одного прохода
+// достаточно: в результате ни одну подсказку (орбиту симметрии) нельзя
+// убрать. Единственность проверяется инкрементально, как в CreatePuzzle:
+// ищется решение с другой цифрой лишь в клетках удаляемой орбиты, на 9×9 —
+// с распространением ограничений (около миллисекунды на задачу). solved
+// должно быть корректным заполненным полем, иначе оно возвращается как есть.
+template <int kBox>
+BasicSudokuGrid<kBox> CreateMinimalPuzzle(const BasicSudokuGrid<kBox>& solved,
+                                          ClueSymmetry symmetry,
+                                          std::mt19937* rng);
+
+struct BulkGenerateOptions {
+  int remove_count = 0;
+  bool use_difficulty = false;  // true — вместо remove_count цель difficulty.
+  Difficulty difficulty = Difficulty::kEasy;
+  std::uint64_t seed = 0;
+  PuzzleCheck check = PuzzleCheck::kUnique;
+  bool minimal = false;  // true — CreateMinimalPuzzle вместо двух целей выше.
+  bool solved_grids = false;  // true — только заполненные поля, без задач.
+  ClueSymmetry symmetry = ClueSymmetry::kNone;
+  int thread_count = 0;  // 0 — по числу ядер.
+};
+
+// Независимый поток ГСЧ для задачи номер index, выведенный из seed.
+std::mt19937 PuzzleRng(std::uint64_t seed, std::uint64_t index);
+
+// Генерирует задачи с номерами [first, first + count) параллельно из полей
+// GenerateRandomSolvedGrid. Задача номер i строится только из
+// PuzzleRng(seed, i), поэтому результат не зависит ни от числа потоков, ни
+// от разбиения на порции.
+void GeneratePuzzles(const BulkGenerateOptions& options, std::uint64_t first,
+                     std::size_t count, std::vector<SudokuGrid>* puzzles);
 
 }  // namespace sudoku
 
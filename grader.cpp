@@ -0,0 +1,73 @@
+#include "grader.h"
+
+namespace sudoku {
+namespace {
+
+// Вес приёма в итоговой оценке; перебор дороже любого из приёмов,
+// и каждый откат добавляет к оценке ещё по единице.
+constexpr long long kNakedSingleScore = 1;
+constexpr long long kHiddenSingleScore = 2;
+constexpr long long kLockedCandidatesScore = 5;
+constexpr long long kSearchScore = 20;
+
+// Порог откатов, отделяющий kHard от kExpert.
+constexpr long long kExpertBacktracks = 50;
+
+}  // namespace
+
+bool GradePuzzle(const SudokuGrid& puzzle, GradeResult* grade) {
+  if (grade == nullptr) return false;
+  *grade = GradeResult();
+
+  SudokuGrid work = puzzle;
+  const PropagationResult result = Propagate(&work, &grade->propagation);
+  if (result == PropagationResult::kContradiction) return false;
+
+  const PropagationStats& p = grade->propagation;
+  if (p.locked_eliminations > 0) {
+    grade->hardest = Technique::kLockedCandidates;
+    grade->score = kLockedCandidatesScore;
+  } else if (p.hidden_singles > 0) {
+    grade->hardest = Technique::kHiddenSingle;
+    grade->score = kHiddenSingleScore;
+  } else {
+    grade->hardest = Technique::kNakedSingle;
+    grade->score = kNakedSingleScore;
+  }
+
+  if (result == PropagationResult::kStuck) {
+    grade->needs_search = true;
+    if (!SolveIterative(&work, CellOrder::kMinRemaining, &grade->search)) {
+      return false;
+    }
+    grade->score = kSearchScore + grade->search.backtracks;
+  }
+  grade->solvable = true;
+
+  if (grade->needs_search) {
+    grade->difficulty = grade->search.backtracks > kExpertBacktracks
+                            ? Difficulty::kExpert
+                            : Difficulty::kHard;
+  } else if (grade->hardest == Technique::kLockedCandidates) {
+    grade->difficulty = Difficulty::kMedium;
+  } else {
+    grade->difficulty = Difficulty::kEasy;
+  }
+  return true;
+}
+
+const char* DifficultyName(Difficulty difficulty) {
+  switch (difficulty) {
+    case Difficulty::kEasy:
+      return "лёгкая";
+    case Difficulty::kMedium:
+      return "средняя";
+    case Difficulty::kHard:
+      return "сложная";
+    case Difficulty::kExpert:
+      return "экспертная";
+  }
+  return "?";
+}
+
+}  // namespace sudoku
@@ -0,0 +1,36 @@
+#ifndef SUDOKU_GRADER_H_
+#define SUDOKU_GRADER_H_
+
+#include "propagation.h"
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+enum class Difficulty {
+  kEasy,    // Достаточно naked/hidden singles.
+  kMedium,  // Нужны locked candidates.
+  kHard,    // Нужен перебор, но с небольшим числом откатов.
+  kExpert,  // Перебор с большим числом откатов.
+};
+
+struct GradeResult {
+  bool solvable = false;
+  bool needs_search = false;
+  Technique hardest = Technique::kNakedSingle;  // Самый сложный из приёмов.
+  PropagationStats propagation;
+  SolveStats search;  // Перебор после неподвижной точки (MRV).
+  long long score = 0;
+  Difficulty difficulty = Difficulty::kEasy;
+};
+
+// Решает задачу приёмами из propagation.h (от простых к сложным), а если их
+// не хватает — перебором MRV, и оценивает сложность по самому сложному
+// понадобившемуся приёму и по числу откатов перебора.
+bool GradePuzzle(const SudokuGrid& puzzle, GradeResult* grade);
+
+const char* DifficultyName(Difficulty difficulty);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_GRADER_H_
@@ -0,0 +1,85 @@
+#include "grid_enumerator.h"
+
+#include "bits.h"
+
+namespace sudoku {
+
+SolvedGridEnumerator::SolvedGridEnumerator(const SudokuGrid& start)
+    : start_(start) {
+  done_ = start.HasConflicts();
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    const int v = start.GetCell(i);
+    cells_[i] = static_cast<std::uint8_t>(v);
+    if (v == 0) {
+      empty_[empty_count_++] = static_cast<std::uint8_t>(i);
+      continue;
+    }
+    rows_[SudokuGrid::RowOf(i)] |= 1u << v;
+    cols_[SudokuGrid::ColOf(i)] |= 1u << v;
+    boxes_[SudokuGrid::BoxOf(i)] |= 1u << v;
+  }
+}
+
+void SolvedGridEnumerator::Place(int depth, int value) {
+  const int i = empty_[depth];
+  const int old = cells_[i];
+  const unsigned bits =
+      (old != 0 ? 1u << old : 0) | (value != 0 ? 1u << value : 0);
+  cells_[i] = static_cast<std::uint8_t>(value);
+  rows_[SudokuGrid::RowOf(i)] ^= bits;
+  cols_[SudokuGrid::ColOf(i)] ^= bits;
+  boxes_[SudokuGrid::BoxOf(i)] ^= bits;
+}
+
+bool SolvedGridEnumerator::Backtrack() {
+  while (depth_ > 0) {
+    const int d = depth_ - 1;
+    if (rest_[d] == 0) {
+      Place(d, 0);
+      --depth_;
+      continue;
+    }
+    const int v = LowestBit(rest_[d]);
+    rest_[d] &= rest_[d] - 1;
+    Place(d, v);
+    return true;
+  }
+  return false;
+}
+
+bool SolvedGridEnumerator::Next(SudokuGrid* grid) {
+  if (done_ || grid == nullptr) return false;
+  // После выданного решения все клетки заполнены: ищем следующее.
+  if (started_ && !Backtrack()) {
+    done_ = true;
+    return false;
+  }
+  started_ = true;
+
+  while (depth_ < empty_count_) {
+    const int i = empty_[depth_];
+    const unsigned mask = ~(rows_[SudokuGrid::RowOf(i)] |
+                            cols_[SudokuGrid::ColOf(i)] |
+                            boxes_[SudokuGrid::BoxOf(i)]) &
+                          SudokuGrid::kAllDigits;
+    if (mask == 0) {
+      if (!Backtrack()) {
+        done_ = true;
+        return false;
+      }
+      continue;
+    }
+    rest_[depth_] = mask & (mask - 1);
+    Place(depth_, LowestBit(mask));
+    ++depth_;
+  }
+
+  *grid = start_;
+  for (int d = 0; d < empty_count_; ++d) {
+    grid->SetCell(empty_[d], cells_[empty_[d]]);
+  }
+  ++count_;
+  return true;
+}
+
+}  // namespace sudoku
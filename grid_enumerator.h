@@ -0,0 +1,49 @@
+#ifndef SUDOKU_GRID_ENUMERATOR_H_
+#define SUDOKU_GRID_ENUMERATOR_H_
+
+#include <array>
+#include <cstdint>
+
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Потоковый перебор всех решений поля 9×9 (для пустого поля — всех
+// заполненных полей) в фиксированном порядке: пустые клетки построчно,
+// цифры по возрастанию. Состояние — стек ещё не испробованных цифр, поэтому
+// Next() продолжает с места предыдущего решения: соседние решения обычно
+// отличаются последними клетками, и выдача идёт со скоростью перебора,
+// без повторного решения и без выделений памяти. Годится для построения
+// корпусов порциями: зафиксированные в start клетки (например, первая
+// строка или полоса) задают часть пространства полей.
+class SolvedGridEnumerator {
+ public:
+  explicit SolvedGridEnumerator(const SudokuGrid& start);
+
+  // Очередное решение. false — решения закончились (или в start повторы).
+  bool Next(SudokuGrid* grid);
+  // Сколько решений уже выдано.
+  std::uint64_t count() const { return count_; }
+
+ private:
+  // Снимает последние цифры, пока у какой-то клетки не найдётся следующая.
+  bool Backtrack();
+  void Place(int depth, int value);
+
+  SudokuGrid start_;
+  std::array<std::uint8_t, SudokuGrid::kCellCount> cells_{};
+  std::array<unsigned, SudokuGrid::kSize> rows_{};
+  std::array<unsigned, SudokuGrid::kSize> cols_{};
+  std::array<unsigned, SudokuGrid::kSize> boxes_{};
+  std::array<std::uint8_t, SudokuGrid::kCellCount> empty_{};  // По порядку.
+  std::array<unsigned, SudokuGrid::kCellCount> rest_{};  // По глубине.
+  int empty_count_ = 0;
+  int depth_ = 0;
+  bool started_ = false;
+  bool done_ = false;
+  std::uint64_t count_ = 0;
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_GRID_ENUMERATOR_H_
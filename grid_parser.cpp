@@ -0,0 +1,194 @@
+#include "grid_parser.h"
+
+#include <algorithm>
+#include <istream>
+
+namespace sudoku {
+namespace {
+
+// Класс байта: 0..N — клетка с этим значением, остальное — ниже.
+constexpr std::int8_t kInvalid = -1;
+constexpr std::int8_t kSeparator = 64;
+constexpr std::int8_t kNewline = 65;
+constexpr std::int8_t kComment = 66;
+
+struct CharClassTable {
+  std::int8_t cls[256];
+};
+
+template <int kBox>
+const CharClassTable& CharClasses() {
+  static const CharClassTable table = [] {
+    CharClassTable t{};
+    for (int ch = 0; ch < 256; ++ch) {
+      const int v = CharToValue(static_cast<char>(ch));
+      t.cls[ch] = v >= 0 && v <= kBox * kBox ? static_cast<std::int8_t>(v)
+                                              : kInvalid;
+    }
+    for (char ch : {' ', '\t', '\r', '\v', '\f', '|', '+', '-'}) {
+      t.cls[static_cast<unsigned char>(ch)] = kSeparator;
+    }
+    t.cls['\n'] = kNewline;
+    t.cls['#'] = kComment;
+    return t;
+  }();
+  return table;
+}
+
+template <int kBox>
+std::int8_t ClassOf(char ch) {
+  return CharClasses<kBox>().cls[static_cast<unsigned char>(ch)];
+}
+
+}  // namespace
+
+template <int kBox>
+bool CellCharToValue(char ch, int* value) {
+  if (value == nullptr) return false;
+
+  const std::int8_t cls = ClassOf<kBox>(ch);
+  if (cls < 0 || cls > kBox * kBox) return false;
+  *value = cls;
+  return true;
+}
+
+bool IsGridSeparator(char ch) { return ClassOf<3>(ch) == kSeparator; }
+
+template <int kBox>
+BasicGridParser<kBox>::BasicGridParser(const char* data, std::size_t size)
+    : cur_(data), end_(data + size) {}
+
+template <int kBox>
+BasicGridParser<kBox>::BasicGridParser(std::istream* in)
+    : in_(in), window_(kWindowSize) {}
+
+template <int kBox>
+bool BasicGridParser<kBox>::Refill() {
+  if (in_ == nullptr || !*in_) return false;
+
+  in_->read(window_.data(), static_cast<std::streamsize>(window_.size()));
+  const std::streamsize n = in_->gcount();
+  if (n <= 0) return false;
+  cur_ = window_.data();
+  end_ = cur_ + n;
+  return true;
+}
+
+template <int kBox>
+void BasicGridParser<kBox>::Fail(std::size_t line, std::size_t column,
+                                 const std::string& reason) {
+  error_ = "строка " + std::to_string(line) + ", столбец " +
+           std::to_string(column) + ": " + reason;
+  done_ = true;
+}
+
+// Строка поля — N клеток; N² клеток допустимы, только если ими поле
+// начинается (компактный формат); строки без клеток — рамка или пустые.
+// В свободной раскладке число клеток в строке не проверяется.
+template <int kBox>
+bool BasicGridParser<kBox>::EndLine() {
+  const bool row = line_cells_ == Grid::kSize;
+  const bool compact =
+      line_cells_ == Grid::kCellCount && filled_ == Grid::kCellCount;
+  if (!free_layout_ && line_cells_ != 0 && !row && !compact) {
+    Fail(line_, 1,
+         "число клеток в строке должно быть " + std::to_string(Grid::kSize) +
+             " (строка поля) или " + std::to_string(Grid::kCellCount) +
+             " (компактный формат)");
+    return false;
+  }
+  ++line_;
+  column_ = 0;
+  line_cells_ = 0;
+  in_comment_ = false;
+  return true;
+}
+
+template <int kBox>
+bool BasicGridParser<kBox>::Next(Grid* grid) {
+  if (grid == nullptr) {
+    error_ = "внутренняя ошибка: grid == nullptr";
+    return false;
+  }
+  if (!ReadCells()) return false;
+
+  Grid tmp;
+  for (int i = 0; i < Grid::kCellCount; ++i) tmp.SetCell(i, cells_[i]);
+  *grid = tmp;
+  return true;
+}
+
+template <int kBox>
+bool BasicGridParser<kBox>::NextCells(std::uint8_t* cells) {
+  if (cells == nullptr) {
+    error_ = "внутренняя ошибка: cells == nullptr";
+    return false;
+  }
+  if (!ReadCells()) return false;
+
+  std::copy(cells_.begin(), cells_.end(), cells);
+  return true;
+}
+
+template <int kBox>
+bool BasicGridParser<kBox>::ReadCells() {
+  if (done_) return false;
+
+  const CharClassTable& classes = CharClasses<kBox>();
+  while (true) {
+    if (cur_ == end_ && !Refill()) {
+      // Конец ввода: последняя строка может быть без '\n'.
+      done_ = true;
+      if (line_cells_ != 0 && !EndLine()) return false;
+      if (filled_ == 0) return false;
+      if (filled_ != Grid::kCellCount) {
+        Fail(first_line_, 1,
+             "неполное поле: клеток меньше " +
+                 std::to_string(Grid::kCellCount));
+        return false;
+      }
+      break;
+    }
+
+    const char ch = *cur_++;
+    ++column_;
+    const std::int8_t cls = classes.cls[static_cast<unsigned char>(ch)];
+
+    if (cls == kNewline) {
+      if (!EndLine()) return false;
+      if (filled_ == Grid::kCellCount) break;
+      continue;
+    }
+    if (in_comment_ || cls == kSeparator) continue;
+    if (cls == kComment) {
+      in_comment_ = true;
+      continue;
+    }
+    if (cls == kInvalid) {
+      Fail(line_, column_,
+           std::string("недопустимый символ (разрешено: 1-") +
+               ValueToChar(Grid::kSize) + ", 0, ., пробелы и рамка)");
+      return false;
+    }
+
+    if (filled_ == Grid::kCellCount) {
+      Fail(line_, column_, "лишняя клетка: поле уже заполнено");
+      return false;
+    }
+    if (filled_ == 0) first_line_ = line_;
+    cells_[filled_++] = static_cast<std::uint8_t>(cls);
+    ++line_cells_;
+  }
+
+  filled_ = 0;
+  ++count_;
+  return true;
+}
+
+#define SUDOKU_INSTANTIATE_PARSER(B)                     \
+  template bool CellCharToValue<B>(char ch, int* value); \
+  template class BasicGridParser<B>;
+SUDOKU_FOR_EACH_BOX_SIZE(SUDOKU_INSTANTIATE_PARSER)
+#undef SUDOKU_INSTANTIATE_PARSER
+
+}  // namespace sudoku
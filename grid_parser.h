@@ -0,0 +1,94 @@
+#ifndef SUDOKU_GRID_PARSER_H_
+#define SUDOKU_GRID_PARSER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Символ клетки поля с блоком kBox: '.' и '0' — пусто, '1'..'9', для
+// полей больше 9×9 — буквы 'A'.. (см. CharToValue).
+template <int kBox = 3>
+bool CellCharToValue(char ch, int* value);
+// Символы, которые между клетками пропускаются: пробелы и рамка
+// ToPrettyString ('|', '+', '-').
+bool IsGridSeparator(char ch);
+
+// Потоковый разбор текста с любым числом полей N×N в смешанных форматах
+// (для 9×9):
+//   - компактный: 81 клетка в одной строке;
+//   - по строкам: 9 строк по 9 клеток (с пробелами, как puzzle1.txt);
+//   - рамка ToPrettyString: строки "+---..." пропускаются.
+// Пустые строки и текст от '#' до конца строки пропускаются. Текст читается
+// окнами фиксированного размера, на поле память не выделяется (строка
+// ошибки формируется только при ошибке).
+template <int kBox>
+class BasicGridParser {
+ public:
+  using Grid = BasicSudokuGrid<kBox>;
+
+  // Разбор буфера в памяти; буфер должен жить дольше парсера.
+  BasicGridParser(const char* data, std::size_t size);
+  // Разбор потока окнами по kWindowSize байт.
+  explicit BasicGridParser(std::istream* in);
+
+  BasicGridParser(const BasicGridParser&) = delete;
+  BasicGridParser& operator=(const BasicGridParser&) = delete;
+
+  // Свободная раскладка: клетки поля считаются подряд без проверки числа
+  // клеток в строке (81 значение через любые пробелы и переводы строк).
+  // Поле заканчивается на конце строки с его последней клеткой.
+  void set_free_layout(bool on) { free_layout_ = on; }
+
+  // Очередное поле. false — конец ввода или ошибка (см. ok()/error()).
+  bool Next(Grid* grid);
+  // То же без построения поля: N² значений клеток в cells (0 — пусто), как
+  // их ждёт ValidateCellBlocks (batch_validator.h).
+  bool NextCells(std::uint8_t* cells);
+
+  bool ok() const { return error_.empty(); }
+  // "строка L, столбец C: причина"; нумерация с 1, столбец — в байтах.
+  const std::string& error() const { return error_; }
+  // Сколько полей уже прочитано.
+  std::size_t count() const { return count_; }
+
+  static constexpr std::size_t kWindowSize = 1 << 16;
+
+ private:
+  // Очередное поле в cells_.
+  bool ReadCells();
+  bool Refill();
+  bool EndLine();
+  void Fail(std::size_t line, std::size_t column, const std::string& reason);
+
+  std::istream* in_ = nullptr;
+  std::vector<char> window_;
+  const char* cur_ = nullptr;
+  const char* end_ = nullptr;
+
+  std::size_t line_ = 1;
+  std::size_t column_ = 0;
+  std::size_t count_ = 0;
+  bool in_comment_ = false;
+  bool free_layout_ = false;
+  bool done_ = false;
+
+  // Текущее поле: filled_ клеток, из них line_cells_ — в текущей строке.
+  std::array<std::uint8_t, Grid::kCellCount> cells_{};
+  int filled_ = 0;
+  int line_cells_ = 0;
+  std::size_t first_line_ = 0;  // Строка первой клетки поля.
+  std::string error_;
+};
+
+using GridParser = BasicGridParser<3>;
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_GRID_PARSER_H_
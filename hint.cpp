@@ -0,0 +1,246 @@
+#include "hint.h"
+
+#include <stdexcept>
+
+#include "bits.h"
+
+namespace sudoku {
+namespace {
+
+constexpr int kPeerCount = 20;
+using PeerTable =
+    std::array<std::array<int, kPeerCount>, SudokuGrid::kCellCount>;
+
+// Соседи клетки: остальные клетки её строки, столбца и блока.
+const PeerTable& Peers() {
+  static const PeerTable table = [] {
+    PeerTable t{};
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+      int n = 0;
+      for (int j = 0; j < SudokuGrid::kCellCount; ++j) {
+        if (j == i) continue;
+        if (SudokuGrid::RowOf(j) == SudokuGrid::RowOf(i) ||
+            SudokuGrid::ColOf(j) == SudokuGrid::ColOf(i) ||
+            SudokuGrid::BoxOf(j) == SudokuGrid::BoxOf(i)) {
+          t[i][n++] = j;
+        }
+      }
+    }
+    return t;
+  }();
+  return table;
+}
+
+// Группы клетки: строка, столбец, блок (нумерация как в UnitCells).
+std::array<int, 3> UnitsOf(int index) {
+  return {SudokuGrid::RowOf(index),
+          SudokuGrid::kSize + SudokuGrid::ColOf(index),
+          2 * SudokuGrid::kSize + SudokuGrid::BoxOf(index)};
+}
+
+unsigned UnitMask(const SudokuGrid& grid, int unit) {
+  if (unit < SudokuGrid::kSize) return grid.RowMask(unit);
+  if (unit < 2 * SudokuGrid::kSize) {
+    return grid.ColMask(unit - SudokuGrid::kSize);
+  }
+  return grid.BoxMask(unit - 2 * SudokuGrid::kSize);
+}
+
+// Single по произвольным маскам кандидатов (после исключений): сначала
+// naked, затем hidden. false — singles нет.
+bool FindSingle(const SudokuGrid& grid,
+                const std::array<std::uint16_t, SudokuGrid::kCellCount>& masks,
+                Hint* hint) {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (grid.GetCell(i) == 0 && PopCount(masks[i]) == 1) {
+      hint->cell = i;
+      hint->value = LowestBit(masks[i]);
+      hint->unit = -1;
+      return true;
+    }
+  }
+
+  const UnitCellTable& units = UnitCells();
+  for (int u = 0; u < kUnitCount; ++u) {
+    unsigned once = 0;
+    unsigned twice = 0;
+    for (int i : units[u]) {
+      twice |= once & masks[i];
+      once |= masks[i];
+    }
+    const unsigned singles = once & ~twice;
+    if (singles == 0) continue;
+
+    const unsigned bit = 1u << LowestBit(singles);
+    for (int i : units[u]) {
+      if ((masks[i] & bit) != 0) {
+        hint->cell = i;
+        hint->value = LowestBit(bit);
+        hint->unit = u;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Один проход pointing/claiming (как ApplyLockedCandidates в
+// propagation.cpp, но по маскам кандидатов). Возвращает число исключений.
+int EliminateLocked(const SudokuGrid& grid,
+                    std::array<std::uint16_t, SudokuGrid::kCellCount>* masks) {
+  const UnitCellTable& units = UnitCells();
+  int removed = 0;
+
+  for (int u = 0; u < kUnitCount; ++u) {
+    const bool is_box = u >= 2 * SudokuGrid::kSize;
+    const unsigned missing = ~UnitMask(grid, u) & SudokuGrid::kAllDigits;
+
+    for (unsigned digits = missing; digits != 0; digits &= digits - 1) {
+      const unsigned bit = 1u << LowestBit(digits);
+      unsigned rows = 0;
+      unsigned cols = 0;
+      unsigned boxes = 0;
+      for (int i : units[u]) {
+        if (((*masks)[i] & bit) == 0) continue;
+        rows |= 1u << SudokuGrid::RowOf(i);
+        cols |= 1u << SudokuGrid::ColOf(i);
+        boxes |= 1u << SudokuGrid::BoxOf(i);
+      }
+      if (rows == 0) continue;
+
+      // Группа, в которой лежат все кандидаты цифры, кроме самой u.
+      int target = -1;
+      if (is_box) {
+        if (PopCount(rows) == 1) {
+          target = LowestBit(rows);
+        } else if (PopCount(cols) == 1) {
+          target = SudokuGrid::kSize + LowestBit(cols);
+        }
+      } else if (PopCount(boxes) == 1) {
+        target = 2 * SudokuGrid::kSize + LowestBit(boxes);
+      }
+      if (target < 0) continue;
+
+      for (int i : units[target]) {
+        if (((*masks)[i] & bit) == 0) continue;
+        const std::array<int, 3> own = UnitsOf(i);
+        if (own[0] == u || own[1] == u || own[2] == u) continue;
+        (*masks)[i] = static_cast<std::uint16_t>((*masks)[i] & ~bit);
+        ++removed;
+      }
+    }
+  }
+  return removed;
+}
+
+}  // namespace
+
+bool HintEngine::Reset(const SudokuGrid& puzzle) {
+  const bool ok = !puzzle.HasConflicts();
+  grid_ = ok ? puzzle : SudokuGrid();
+  for (auto& unit : places_) unit.fill(0);
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    given_[i] = grid_.GetCell(i) != 0 ? 1 : 0;
+    candidates_[i] = 0;
+    Refresh(i);
+  }
+  return ok;
+}
+
+void HintEngine::Refresh(int index) {
+  const std::uint16_t mask =
+      grid_.GetCell(index) == 0 ? grid_.CandidateMask(index) : 0;
+  const unsigned added = mask & ~candidates_[index];
+  const unsigned removed = candidates_[index] & ~mask;
+  candidates_[index] = mask;
+  if ((added | removed) == 0) return;
+
+  for (int u : UnitsOf(index)) {
+    for (unsigned b = added; b != 0; b &= b - 1) ++places_[u][LowestBit(b)];
+    for (unsigned b = removed; b != 0; b &= b - 1) --places_[u][LowestBit(b)];
+  }
+}
+
+bool HintEngine::HasDeadEnd() const {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (grid_.GetCell(i) == 0 && candidates_[i] == 0) return true;
+  }
+  for (int u = 0; u < kUnitCount; ++u) {
+    const unsigned missing = ~UnitMask(grid_, u) & SudokuGrid::kAllDigits;
+    for (unsigned b = missing; b != 0; b &= b - 1) {
+      if (places_[u][LowestBit(b)] == 0) return true;
+    }
+  }
+  return false;
+}
+
+MoveStatus HintEngine::Set(int row, int col, int value) {
+  if (row < 0 || row >= SudokuGrid::kSize || col < 0 ||
+      col >= SudokuGrid::kSize || value < 0 || value > SudokuGrid::kSize) {
+    throw std::out_of_range("HintEngine::Set: клетка или цифра вне поля");
+  }
+  const int index = row * SudokuGrid::kSize + col;
+  if (given_[index] != 0) return MoveStatus::kGiven;
+
+  if (value != 0 && value != grid_.GetCell(index)) {
+    const unsigned used = grid_.RowMask(row) | grid_.ColMask(col) |
+                          grid_.BoxMask(SudokuGrid::BoxIndex(row, col));
+    if ((used & (1u << value)) != 0) return MoveStatus::kConflict;
+  }
+
+  grid_.SetCell(index, value);
+  Refresh(index);
+  for (int peer : Peers()[index]) Refresh(peer);
+  return HasDeadEnd() ? MoveStatus::kDeadEnd : MoveStatus::kOk;
+}
+
+HintStatus HintEngine::NextHint(Hint* hint) const {
+  if (HasDeadEnd()) return HintStatus::kContradiction;
+
+  bool has_empty = false;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (grid_.GetCell(i) != 0) continue;
+    has_empty = true;
+    if (PopCount(candidates_[i]) == 1) {
+      hint->cell = i;
+      hint->value = LowestBit(candidates_[i]);
+      hint->technique = Technique::kNakedSingle;
+      hint->unit = -1;
+      return HintStatus::kFound;
+    }
+  }
+  if (!has_empty) return HintStatus::kSolved;
+
+  // Число мест уже посчитано: клетку ищем только в группе с единственным.
+  const UnitCellTable& units = UnitCells();
+  for (int u = 0; u < kUnitCount; ++u) {
+    for (int v = 1; v <= SudokuGrid::kSize; ++v) {
+      if (places_[u][v] != 1) continue;
+      for (int i : units[u]) {
+        if ((candidates_[i] & (1u << v)) != 0) {
+          hint->cell = i;
+          hint->value = v;
+          hint->technique = Technique::kHiddenSingle;
+          hint->unit = u;
+          return HintStatus::kFound;
+        }
+      }
+    }
+  }
+
+  Masks masks = candidates_;
+  while (EliminateLocked(grid_, &masks) > 0) {
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+      if (grid_.GetCell(i) == 0 && masks[i] == 0) {
+        return HintStatus::kContradiction;
+      }
+    }
+    if (FindSingle(grid_, masks, hint)) {
+      hint->technique = Technique::kLockedCandidates;
+      return HintStatus::kFound;
+    }
+  }
+  return HintStatus::kStuck;
+}
+
+}  // namespace sudoku
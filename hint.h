@@ -0,0 +1,80 @@
+#ifndef SUDOKU_HINT_H_
+#define SUDOKU_HINT_H_
+
+#include <array>
+#include <cstdint>
+
+#include "propagation.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Следующий логический ход: цифра value в клетку cell, выведенная приёмом
+// technique. Для hidden single unit — группа (0..8 строки, 9..17 столбцы,
+// 18..26 блоки), где у цифры одно место; для kLockedCandidates ход
+// становится single после исключений pointing/claiming.
+struct Hint {
+  int cell = -1;
+  int value = 0;
+  Technique technique = Technique::kNakedSingle;
+  int unit = -1;
+};
+
+enum class MoveStatus {
+  kOk,
+  kConflict,  // Цифра уже есть в строке, столбце или блоке; поле не изменено.
+  kGiven,     // Клетка исходной задачи; поле не изменено.
+  kDeadEnd,   // Ход сделан, но клетке или цифре в группе не осталось места.
+};
+
+enum class HintStatus {
+  kFound,
+  kSolved,         // Пустых клеток нет.
+  kContradiction,  // Клетке или цифре в группе не осталось места.
+  kStuck,          // Приёмов из propagation.h не хватает, нужен перебор.
+};
+
+// Подсказки для интерактивной игры на поле 9×9. Кандидаты клеток и число
+// мест каждой цифры в каждой группе поддерживаются инкрементально: ход
+// пересчитывает только клетку и её 20 соседей, поэтому и ход, и подсказка
+// (naked/hidden single) занимают около микросекунды, без решения поля.
+// Locked candidates считаются по копии кандидатов, только если singles нет.
+// Поле движка всегда без повторов: конфликтный ход отклоняется по маскам
+// групп, без IsGridValid.
+class HintEngine {
+ public:
+  HintEngine() { Reset(SudokuGrid()); }
+  explicit HintEngine(const SudokuGrid& puzzle) { Reset(puzzle); }
+
+  // Новая задача: заполненные клетки становятся исходными. Поле с
+  // повторами принимается пустым (false).
+  bool Reset(const SudokuGrid& puzzle);
+
+  const SudokuGrid& grid() const { return grid_; }
+  bool IsGiven(int index) const { return given_[index] != 0; }
+
+  // value 0 — стереть клетку.
+  MoveStatus Set(int row, int col, int value);
+  MoveStatus Clear(int row, int col) { return Set(row, col, 0); }
+
+  HintStatus NextHint(Hint* hint) const;
+
+ private:
+  using Masks = std::array<std::uint16_t, SudokuGrid::kCellCount>;
+  using Places = std::array<std::array<std::uint8_t, SudokuGrid::kSize + 1>,
+                            kUnitCount>;
+
+  // Пересчитывает кандидатов клетки по маскам поля и обновляет places_.
+  void Refresh(int index);
+  // Пустая клетка без кандидатов или недостающая цифра группы без места.
+  bool HasDeadEnd() const;
+
+  SudokuGrid grid_;
+  std::array<std::uint8_t, SudokuGrid::kCellCount> given_{};
+  Masks candidates_{};  // 0 у заполненных клеток.
+  Places places_{};     // places_[unit][v] — клеток группы с кандидатом v.
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_HINT_H_
@@ -1,23 +1,73 @@
 /*
 Компиляция:
-g++ -std=c++17 -Wall -Wextra -Wpedantic -O2 *.cpp -o sudoku
+g++ -std=c++17 -Wall -Wextra -Wpedantic -O2 -pthread *.cpp -o sudoku
 ./sudoku
+Проверки: sh tests/run_tests.sh
+
+Без аргументов — интерактивное меню. Подкоманды для скриптов и конвейеров
+(флаги "--имя значение" или "--имя=значение"; путь "-" и путь по
+умолчанию — stdin/stdout; ./sudoku help — список):
+./sudoku solve [--in F] [--out F] [--threads N] [--engine prop|mrv|dlx]
+               [--stats] [--cache]
+  по одной задаче из 81 символа на строку; stats — вывести в stderr
+  гистограммы времени, узлов, откатов и глубины перебора по задачам;
+  cache — не решать повторно задачи, эквивалентные уже решённым (кэш по
+  канонической форме). batch — прежнее имя solve.
+./sudoku validate [--in F] [--out F]
+  на каждое поле строка "<поле> ok" или "<поле> invalid <причина>"; код
+  возврата 1, если есть некорректные поля.
+./sudoku generate --count N (--remove K | --difficulty easy|medium|hard|
+                  expert | --minimal [--symmetry none|rotational|quarter|
+                  mirror|diagonal] | --solved) [--seed S] [--out F]
+                  [--threads N]
+  задачи с единственным решением; результат зависит только от seed (без
+  --seed он выбирается случайно и печатается в stderr). --minimal —
+  ни одной лишней подсказки, рисунок подсказок с заданной симметрией;
+  --solved — только заполненные поля.
+./sudoku enumerate [--in F] [--count N] [--out F]
+  все решения первого поля из F (без --in — все заполненные поля) по
+  порядку; N == 0 — без ограничения.
+./sudoku pack --in F.txt --out F.sdkc
+  текстовый набор -> двоичный корпус (solve и validate принимают оба).
+./sudoku store --db F [--in F] [--out F] [--canonical] [--solve | --check]
+               [--threads N]
+  добавляет задачи в архив F без повторов (--canonical — повтором
+  считается и эквивалентная задача; задаётся при создании архива), --solve
+  — с решениями; --check — только сверяет с архивом. В --out — новые
+  задачи.
+./sudoku bench [--corpus DIR] [--easy N]
+  замеры решателей, генератора и проверки (медиана/p99, опер./с, выделения).
+
+Прежний позиционный синтаксис тоже работает, например
+./sudoku batch <вход> <выход> [потоков] [prop|mrv|dlx] [stats] [cache]
+./sudoku generate <количество> <удалить|сложность> <seed> <выход> [потоков]
 
 
 */
 
+#include <chrono>
 #include <iostream>
 #include <random>
 #include <string>
 
+#include "cli.h"
 #include "console_ui.h"
 #include "file_io.h"
 #include "generator.h"
+#include "grader.h"
+#include "hint.h"
+#include "parallel_solver.h"
 #include "solver.h"
 #include "sudoku_grid.h"
 
 namespace {
 
+constexpr std::chrono::seconds kMenuSolveTimeout(10);
+
+constexpr sudoku::PuzzleCheck kPuzzleChecks[] = {
+    sudoku::PuzzleCheck::kNone, sudoku::PuzzleCheck::kSolvable,
+    sudoku::PuzzleCheck::kUnique};
+
 void PrintMenu() {
   std::cout << "\n===== SUDOKU =====\n"
             << "1) Показать текущее поле\n"
@@ -25,16 +75,24 @@ void PrintMenu() {
             << "3) Загрузить из файла\n"
             << "4) Сохранить в файл\n"
             << "5) Проверка корректности поля\n"
-            << "6) Решить (итеративно, без рекурсии)\n"
+            << "6) Решить (итеративно, без рекурсии, на всех ядрах)\n"
             << "7) Сгенерировать заполненное корректное судоку\n"
             << "8) Создать задачу (удалить числа)\n"
+            << "9) Оценить сложность задачи\n"
+            << "10) Подсказка: следующий логический ход\n"
+            << "11) Поставить или стереть цифру (с проверкой хода)\n"
             << "0) Выход\n";
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char* argv[]) {
+  if (argc > 1 && cli::IsCommand(argv[1])) {
+    return cli::RunCommand(argc, argv);
+  }
+
   sudoku::SudokuGrid grid;
+  sudoku::HintEngine hints;
   std::random_device rd;
   std::mt19937 rng(rd());
 
@@ -42,7 +100,7 @@ int main() {
     PrintMenu();
 
     int choice = 0;
-    if (!console_ui::ReadIntInRange("Выберите пункт: ", 0, 8, &choice)) {
+    if (!console_ui::ReadIntInRange("Выберите пункт: ", 0, 11, &choice)) {
       std::cout << "Ошибка ввода.\n";
       continue;
     }
@@ -71,6 +129,7 @@ int main() {
           break;
         }
         grid = tmp;
+        hints.Reset(grid);
         std::cout << "Поле обновлено.\n";
         break;
       }
@@ -92,6 +151,7 @@ int main() {
           break;
         }
         grid = tmp;
+        hints.Reset(grid);
         std::cout << "Загружено успешно.\n";
         break;
       }
@@ -125,16 +185,26 @@ int main() {
           break;
         }
         sudoku::SudokuGrid tmp = grid;
-        if (!sudoku::SolveIterative(&tmp)) {
+        sudoku::ParallelSolveOptions options;
+        options.deadline = std::chrono::steady_clock::now() + kMenuSolveTimeout;
+        const sudoku::SolveResult result =
+            sudoku::SolveParallel(&tmp, options, nullptr);
+        if (result == sudoku::SolveResult::kBudgetExhausted) {
+          std::cout << "Перебор прерван: превышено время ожидания.\n";
+          break;
+        }
+        if (result != sudoku::SolveResult::kSolved) {
           std::cout << "Решение не найдено (или поле противоречиво).\n";
           break;
         }
         grid = tmp;
+        hints.Reset(grid);
         std::cout << "Решено:\n" << grid.ToPrettyString() << "\n";
         break;
       }
       case 7: {
-        grid = sudoku::GenerateSolvedGrid(&rng);
+        grid = sudoku::GenerateRandomSolvedGrid(&rng);
+        hints.Reset(grid);
         std::cout << "Сгенерировано заполненное корректное судоку:\n"
                   << grid.ToPrettyString() << "\n";
         break;
@@ -149,8 +219,9 @@ int main() {
 
         int ensure = 0;
         if (!console_ui::ReadIntInRange(
-                "Проверять решаемость после каждого удаления? 1-да, 0-нет: ", 0, 1,
-                &ensure)) {
+                "Проверка после каждого удаления: 0-нет, 1-решаемость, "
+                "2-единственность решения: ",
+                0, 2, &ensure)) {
           std::cout << "Ошибка ввода.\n";
           break;
         }
@@ -163,22 +234,92 @@ int main() {
 
         std::string reason;
         if (!sudoku::IsGridValid(grid, &reason)) {
-            std::cout << "Нельзя создать задачу: текущее решение некорректно: " << reason
-                      << "\n";
-            break;
-}
-
+          std::cout << "Нельзя создать задачу: текущее решение некорректно: "
+                    << reason << "\n";
+          break;
+        }
 
         int removed = 0;
         sudoku::SudokuGrid puzzle =
-            sudoku::CreatePuzzle(grid, remove_count, ensure == 1, &rng, &removed);
+            sudoku::CreatePuzzle(grid, remove_count, kPuzzleChecks[ensure], &rng,
+                                 &removed);
 
         grid = puzzle;
+        hints.Reset(grid);
         std::cout << "Задача создана: удалено " << removed << " из " << remove_count
                   << ".\n"
                   << grid.ToPrettyString() << "\n";
         break;
       }
+      case 9: {
+        sudoku::GradeResult grade;
+        if (!sudoku::GradePuzzle(grid, &grade)) {
+          std::cout << "Задача не решается.\n";
+          break;
+        }
+        std::cout << "Сложность: " << sudoku::DifficultyName(grade.difficulty)
+                  << " (оценка " << grade.score << ").\n"
+                  << "Naked singles: " << grade.propagation.naked_singles
+                  << ", hidden singles: " << grade.propagation.hidden_singles
+                  << ", исключений locked candidates: "
+                  << grade.propagation.locked_eliminations << ".\n";
+        if (grade.needs_search) {
+          std::cout << "Перебор: " << grade.search.nodes << " ходов, "
+                    << grade.search.backtracks << " откатов.\n";
+        }
+        break;
+      }
+      case 10: {
+        sudoku::Hint hint;
+        const sudoku::HintStatus status = hints.NextHint(&hint);
+        if (status == sudoku::HintStatus::kSolved) {
+          std::cout << "Пустых клеток нет.\n";
+          break;
+        }
+        if (status == sudoku::HintStatus::kContradiction) {
+          std::cout << "Тупик: клетке или цифре не осталось места, "
+                       "где-то выше ошибка.\n";
+          break;
+        }
+        if (status == sudoku::HintStatus::kStuck) {
+          std::cout << "Простых приёмов не хватает, нужен перебор.\n";
+          break;
+        }
+        std::cout << "Строка " << sudoku::SudokuGrid::RowOf(hint.cell) + 1
+                  << ", столбец " << sudoku::SudokuGrid::ColOf(hint.cell) + 1
+                  << ": цифра " << hint.value << " ("
+                  << sudoku::TechniqueName(hint.technique) << ").\n";
+        break;
+      }
+      case 11: {
+        int row = 0;
+        int col = 0;
+        int value = 0;
+        if (!console_ui::ReadIntInRange("Строка (1..9): ", 1, 9, &row) ||
+            !console_ui::ReadIntInRange("Столбец (1..9): ", 1, 9, &col) ||
+            !console_ui::ReadIntInRange("Цифра (0 — стереть): ", 0, 9,
+                                        &value)) {
+          std::cout << "Ошибка ввода.\n";
+          break;
+        }
+        const sudoku::MoveStatus status = hints.Set(row - 1, col - 1, value);
+        if (status == sudoku::MoveStatus::kConflict) {
+          std::cout << "Нельзя: цифра " << value
+                    << " уже есть в строке, столбце или блоке.\n";
+          break;
+        }
+        if (status == sudoku::MoveStatus::kGiven) {
+          std::cout << "Нельзя: это клетка исходной задачи.\n";
+          break;
+        }
+        grid = hints.grid();
+        if (status == sudoku::MoveStatus::kDeadEnd) {
+          std::cout << "Ход сделан, но ведёт в тупик: клетке или цифре не "
+                       "осталось места.\n";
+        }
+        std::cout << grid.ToPrettyString() << "\n";
+        break;
+      }
       default:
         std::cout << "Неизвестный пункт.\n";
         break;
@@ -0,0 +1,58 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace sudoku {
+namespace {
+
+// Блок индексов за одно обращение к счётчику: около kChunksPerThread
+// блоков на поток, чтобы даже небольшой набор тяжёлых задач разошёлся по
+// всем потокам, но не больше kMaxChunk.
+constexpr std::size_t kChunksPerThread = 8;
+constexpr std::size_t kMaxChunk = 64;
+
+}  // namespace
+
+int DefaultThreadCount() {
+  const unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : static_cast<int>(n);
+}
+
+void ParallelFor(std::size_t count, int thread_count,
+                 const std::function<void(std::size_t)>& fn) {
+  if (count == 0) return;
+  if (thread_count <= 0) thread_count = DefaultThreadCount();
+
+  const std::size_t chunk = std::clamp<std::size_t>(
+      count / (static_cast<std::size_t>(thread_count) * kChunksPerThread), 1,
+      kMaxChunk);
+  const std::size_t max_useful = (count + chunk - 1) / chunk;
+  const int workers =
+      static_cast<int>(std::min<std::size_t>(thread_count, max_useful));
+
+  std::atomic<std::size_t> next{0};
+  auto work = [&]() {
+    while (true) {
+      const std::size_t begin = next.fetch_add(chunk);
+      if (begin >= count) return;
+      const std::size_t end = std::min(count, begin + chunk);
+      for (std::size_t i = begin; i < end; ++i) fn(i);
+    }
+  };
+
+  if (workers <= 1) {
+    work();
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (int t = 1; t < workers; ++t) threads.emplace_back(work);
+  work();
+  for (std::thread& th : threads) th.join();
+}
+
+}  // namespace sudoku
@@ -0,0 +1,21 @@
+#ifndef SUDOKU_PARALLEL_H_
+#define SUDOKU_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace sudoku {
+
+// Число потоков по умолчанию: std::thread::hardware_concurrency(), минимум 1.
+int DefaultThreadCount();
+
+// Вызывает fn(i) для каждого i из [0, count) на thread_count потоках
+// (thread_count <= 0 — по числу ядер). Индексы раздаются через атомарный
+// счётчик блоками по count / (8 · потоки), от 1 до 64 индексов: даже
+// несколько десятков «тяжёлых» задач расходятся по всем потокам.
+void ParallelFor(std::size_t count, int thread_count,
+                 const std::function<void(std::size_t)>& fn);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_PARALLEL_H_
@@ -0,0 +1,282 @@
+#include "parallel_solver.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bits.h"
+#include "parallel.h"
+
+namespace sudoku {
+namespace {
+
+// Подзадач на поток при автоматическом выборе глубины: с запасом, чтобы
+// неравные поддеревья выровнялись перехватом.
+constexpr int kTasksPerThread = 8;
+constexpr int kMaxSplitDepth = 16;
+
+template <int kBox>
+struct SplitTask {
+  BasicSudokuGrid<kBox> grid;
+  int branch_depth = 0;  // Узлы ветвления (больше одного кандидата).
+  int placed = 0;        // Все цифры, поставленные при разбиении.
+};
+
+// Очередь подзадач на каждый поток. Владелец берёт с конца (последнюю
+// отложенную — самое мелкое и «тёплое» поддерево), чужой поток перехватывает
+// с начала (самое крупное). Очереди короткие и трогаются раз на подзадачу,
+// поэтому простого мьютекса на очередь достаточно.
+template <typename Task>
+class StealingQueues {
+ public:
+  explicit StealingQueues(int workers) : queues_(workers) {}
+
+  void Push(int worker, Task task) {
+    pending_.fetch_add(1);
+    std::lock_guard<std::mutex> lock(queues_[worker].mutex);
+    queues_[worker].tasks.push_back(std::move(task));
+  }
+
+  bool Pop(int worker, Task* task) {
+    {
+      Queue& own = queues_[worker];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        *task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    const int n = static_cast<int>(queues_.size());
+    for (int k = 1; k < n; ++k) {
+      Queue& victim = queues_[(worker + k) % n];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        *task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Подзадача обработана (её дочерние уже в очередях).
+  void Done() { pending_.fetch_sub(1); }
+  bool Idle() const { return pending_.load() == 0; }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<Queue> queues_;
+  std::atomic<int> pending_{0};
+};
+
+int AutoSplitDepth(int workers) {
+  int depth = 1;
+  while (depth < kMaxSplitDepth && (1 << depth) < kTasksPerThread * workers) {
+    ++depth;
+  }
+  return depth;
+}
+
+// Спускается от подзадачи по MRV: вынужденные ходы делает сразу, в узле
+// ветвления оставляет себе первого кандидата, остальных откладывает в
+// очередь потока. false — тупик (клетка без кандидатов).
+template <int kBox>
+bool Split(SplitTask<kBox>* task, int split_depth, int worker,
+           const std::atomic<bool>& stop,
+           StealingQueues<SplitTask<kBox>>* queues, SolveStats* stats) {
+  using Grid = BasicSudokuGrid<kBox>;
+
+  while (task->branch_depth < split_depth && !stop.load()) {
+    int best = -1;
+    int best_count = Grid::kSize + 1;
+    for (int i = 0; i < Grid::kCellCount; ++i) {
+      if (task->grid.GetCell(i) != 0) continue;
+      const int n = PopCount(task->grid.CandidateMask(i));
+      if (n < best_count) {
+        best = i;
+        best_count = n;
+        if (n <= 1) break;
+      }
+    }
+    if (best < 0) return true;  // Поле заполнено — решение.
+    if (best_count == 0) {
+      ++stats->backtracks;
+      return false;
+    }
+
+    unsigned rest = task->grid.CandidateMask(best);
+    const int first = LowestBit(rest);
+    rest &= rest - 1;
+    if (rest != 0) {
+      // Старшие цифры кладутся первыми: владелец возьмёт следующую по
+      // порядку, перехватчик — самую дальнюю.
+      std::array<int, Grid::kSize> others{};
+      int count = 0;
+      for (; rest != 0; rest &= rest - 1) others[count++] = LowestBit(rest);
+      for (int k = count - 1; k >= 0; --k) {
+        SplitTask<kBox> child = *task;
+        child.grid.SetCell(best, others[k]);
+        ++child.branch_depth;
+        ++child.placed;
+        queues->Push(worker, std::move(child));
+        ++stats->nodes;
+      }
+      ++task->branch_depth;
+    } else {
+      ++stats->propagation_hits;
+    }
+    task->grid.SetCell(best, first);
+    ++task->placed;
+    ++stats->nodes;
+    stats->max_depth = std::max(stats->max_depth, task->placed);
+  }
+  return true;
+}
+
+// Общий каркас: разбиение дерева и раздача подзадач; leaf(grid, limits,
+// stats) перебирает поддерево целиком и сам решает, когда выставить stop.
+// Счётчики потоков складываются в stats (время не складывается: его
+// учитывает вызывающий по общим часам).
+template <int kBox, typename Leaf>
+void RunSplitSearch(const BasicSudokuGrid<kBox>& root,
+                    const ParallelSolveOptions& options,
+                    std::atomic<bool>* stop, SolveStats* stats, Leaf leaf) {
+  const int workers = options.thread_count > 0 ? options.thread_count
+                                               : DefaultThreadCount();
+  const int split_depth = options.split_depth > 0
+                              ? std::min(options.split_depth, kMaxSplitDepth)
+                              : AutoSplitDepth(workers);
+
+  SolveLimits limits;
+  limits.deadline = options.deadline;
+  limits.cancel = stop;
+
+  StealingQueues<SplitTask<kBox>> queues(workers);
+  SplitTask<kBox> root_task;
+  root_task.grid = root;
+  queues.Push(0, std::move(root_task));
+
+  std::vector<SolveStats> worker_stats(workers);
+  auto work = [&](int worker) {
+    SolveStats* s = &worker_stats[worker];
+    SplitTask<kBox> task;
+    while (!stop->load()) {
+      if (!queues.Pop(worker, &task)) {
+        if (queues.Idle()) return;
+        std::this_thread::yield();
+        continue;
+      }
+      if (Split(&task, split_depth, worker, *stop, &queues, s)) {
+        SolveStats leaf_stats;
+        leaf(&task.grid, limits, &leaf_stats);
+        s->nodes += leaf_stats.nodes;
+        s->backtracks += leaf_stats.backtracks;
+        s->propagation_hits += leaf_stats.propagation_hits;
+        s->max_depth =
+            std::max(s->max_depth, task.placed + leaf_stats.max_depth);
+      }
+      queues.Done();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (int t = 1; t < workers; ++t) threads.emplace_back(work, t);
+  work(0);
+  for (std::thread& th : threads) th.join();
+
+  for (const SolveStats& s : worker_stats) {
+    stats->nodes += s.nodes;
+    stats->backtracks += s.backtracks;
+    stats->propagation_hits += s.propagation_hits;
+    stats->max_depth = std::max(stats->max_depth, s.max_depth);
+  }
+}
+
+}  // namespace
+
+template <int kBox>
+SolveResult SolveParallel(BasicSudokuGrid<kBox>* grid,
+                          const ParallelSolveOptions& options,
+                          SolveStats* stats) {
+  using Grid = BasicSudokuGrid<kBox>;
+  if (grid == nullptr) return SolveResult::kUnsolvable;
+  if (grid->HasConflicts()) return SolveResult::kUnsolvable;
+
+  ScopedSolveTimer timer(stats);
+  SolveStats local;
+  SolveStats* s = stats != nullptr ? stats : &local;
+
+  std::atomic<bool> stop{false};
+  std::atomic<bool> solved{false};
+  std::atomic<bool> expired{false};
+  Grid solution;
+  RunSplitSearch(*grid, options, &stop, s,
+                 [&](Grid* work, const SolveLimits& limits,
+                     SolveStats* leaf_stats) {
+                   const SolveResult r = SolveIterative(
+                       work, CellOrder::kMinRemaining, limits, leaf_stats);
+                   if (r == SolveResult::kSolved) {
+                     if (!solved.exchange(true)) solution = *work;
+                     stop.store(true);
+                   } else if (r == SolveResult::kBudgetExhausted &&
+                              std::chrono::steady_clock::now() >=
+                                  options.deadline) {
+                     expired.store(true);
+                     stop.store(true);
+                   }
+                 });
+
+  if (solved.load()) {
+    *grid = solution;
+    return SolveResult::kSolved;
+  }
+  return expired.load() ? SolveResult::kBudgetExhausted
+                        : SolveResult::kUnsolvable;
+}
+
+template <int kBox>
+int CountSolutionsParallel(const BasicSudokuGrid<kBox>& grid, int limit,
+                           const ParallelSolveOptions& options) {
+  using Grid = BasicSudokuGrid<kBox>;
+  if (limit <= 0) return 0;
+  if (grid.HasConflicts()) return 0;
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> total{0};
+  SolveStats stats;
+  RunSplitSearch(grid, options, &stop, &stats,
+                 [&](Grid* work, const SolveLimits& limits,
+                     SolveStats* leaf_stats) {
+                   const int want = limit - total.load();
+                   if (want <= 0) {
+                     stop.store(true);
+                     return;
+                   }
+                   const int n = CountSolutions(*work, want, limits,
+                                                leaf_stats);
+                   if (total.fetch_add(n) + n >= limit) stop.store(true);
+                 });
+  return std::min(total.load(), limit);
+}
+
+#define SUDOKU_INSTANTIATE_PARALLEL_SOLVER(B)                          \
+  template SolveResult SolveParallel<B>(                               \
+      BasicSudokuGrid<B>* grid, const ParallelSolveOptions& options,   \
+      SolveStats* stats);                                              \
+  template int CountSolutionsParallel<B>(                              \
+      const BasicSudokuGrid<B>& grid, int limit,                       \
+      const ParallelSolveOptions& options);
+SUDOKU_FOR_EACH_BOX_SIZE(SUDOKU_INSTANTIATE_PARALLEL_SOLVER)
+#undef SUDOKU_INSTANTIATE_PARALLEL_SOLVER
+
+}  // namespace sudoku
@@ -0,0 +1,42 @@
+#ifndef SUDOKU_PARALLEL_SOLVER_H_
+#define SUDOKU_PARALLEL_SOLVER_H_
+
+#include <chrono>
+
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+struct ParallelSolveOptions {
+  int thread_count = 0;  // <= 0 — по числу ядер.
+  // Глубина разбиения: до неё узел дерева (клетка с наименьшим числом
+  // кандидатов) становится отдельными подзадачами по кандидатам, глубже
+  // подзадача перебирается MRV целиком. 0 — подобрать по числу потоков.
+  int split_depth = 0;
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+};
+
+// Параллельный MRV-перебор одной задачи: дерево поиска делится на
+// подзадачи на малой глубине, подзадачи раздаются пулу с work stealing
+// (свою очередь поток разбирает с конца, чужие — с начала, где лежат
+// крупные поддеревья). Первое найденное решение останавливает остальные
+// потоки. kBudgetExhausted — только по сроку; при любом результате, кроме
+// kSolved, поле не меняется. stats может быть nullptr; узлы и откаты
+// суммируются по потокам, время — общее.
+template <int kBox>
+SolveResult SolveParallel(BasicSudokuGrid<kBox>* grid,
+                          const ParallelSolveOptions& options,
+                          SolveStats* stats);
+
+// Число решений с отсечкой limit (как CountSolutions): решения подзадач
+// суммируются, при достижении limit остальные потоки останавливаются.
+// После срока — число решений, найденных до него (оценка снизу).
+template <int kBox>
+int CountSolutionsParallel(const BasicSudokuGrid<kBox>& grid, int limit,
+                           const ParallelSolveOptions& options);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_PARALLEL_SOLVER_H_
@@ -0,0 +1,258 @@
+#include "propagation.h"
+
+#include "bits.h"
+#include "solver.h"
+
+namespace sudoku {
+namespace {
+
+enum class StepResult { kNoProgress, kProgress, kContradiction };
+
+std::uint16_t UnitMask(const SudokuGrid& grid, int unit) {
+  if (unit < SudokuGrid::kSize) return grid.RowMask(unit);
+  if (unit < 2 * SudokuGrid::kSize) return grid.ColMask(unit - SudokuGrid::kSize);
+  return grid.BoxMask(unit - 2 * SudokuGrid::kSize);
+}
+
+unsigned Candidates(const SudokuGrid& grid, const EliminationMasks& elim,
+                    int index) {
+  return grid.CandidateMask(index) & elim[index];
+}
+
+StepResult ApplyNakedSingles(SudokuGrid* grid, const EliminationMasks& elim,
+                             PropagationStats* stats) {
+  StepResult result = StepResult::kNoProgress;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (grid->GetCell(i) != 0) continue;
+    const unsigned cand = Candidates(*grid, elim, i);
+    if (cand == 0) return StepResult::kContradiction;
+    if ((cand & (cand - 1)) != 0) continue;
+
+    grid->SetCell(i, LowestBit(cand));
+    ++stats->naked_singles;
+    result = StepResult::kProgress;
+  }
+  return result;
+}
+
+StepResult ApplyHiddenSingles(SudokuGrid* grid, const EliminationMasks& elim,
+                              PropagationStats* stats) {
+  const UnitCellTable& units = UnitCells();
+  StepResult result = StepResult::kNoProgress;
+
+  for (int u = 0; u < kUnitCount; ++u) {
+    unsigned once = 0;
+    unsigned twice = 0;
+    for (int i : units[u]) {
+      if (grid->GetCell(i) != 0) continue;
+      const unsigned cand = Candidates(*grid, elim, i);
+      twice |= once & cand;
+      once |= cand;
+    }
+
+    if ((once | UnitMask(*grid, u)) != SudokuGrid::kAllDigits) {
+      return StepResult::kContradiction;
+    }
+
+    for (unsigned singles = once & ~twice; singles != 0; singles &= singles - 1) {
+      const int v = LowestBit(singles);
+      const unsigned bit = 1u << v;
+      for (int i : units[u]) {
+        if (grid->GetCell(i) == 0 && (Candidates(*grid, elim, i) & bit) != 0) {
+          grid->SetCell(i, v);
+          ++stats->hidden_singles;
+          result = StepResult::kProgress;
+          break;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+// Исключает цифру bit из клеток группы unit, не лежащих в группе keep_unit.
+int EliminateOutside(const SudokuGrid& grid, int unit, int keep_unit,
+                     unsigned bit, EliminationMasks* elim) {
+  const UnitCellTable& units = UnitCells();
+  int removed = 0;
+  for (int i : units[unit]) {
+    if (grid.GetCell(i) != 0) continue;
+
+    bool inside = false;
+    for (int k : units[keep_unit]) {
+      if (k == i) {
+        inside = true;
+        break;
+      }
+    }
+    if (inside) continue;
+
+    if ((Candidates(grid, *elim, i) & bit) != 0) {
+      (*elim)[i] = static_cast<std::uint16_t>((*elim)[i] & ~bit);
+      ++removed;
+    }
+  }
+  return removed;
+}
+
+// Pointing: кандидаты цифры в блоке лежат в одной строке/столбце — цифра
+// исключается из остальной строки/столбца. Claiming: кандидаты цифры в
+// строке/столбце лежат в одном блоке — цифра исключается из остального блока.
+StepResult ApplyLockedCandidates(const SudokuGrid& grid, EliminationMasks* elim,
+                                 PropagationStats* stats) {
+  const UnitCellTable& units = UnitCells();
+  int removed = 0;
+
+  for (int u = 0; u < kUnitCount; ++u) {
+    const bool is_box = u >= 2 * SudokuGrid::kSize;
+    const unsigned missing = ~UnitMask(grid, u) & SudokuGrid::kAllDigits;
+
+    for (unsigned digits = missing; digits != 0; digits &= digits - 1) {
+      const unsigned bit = 1u << LowestBit(digits);
+
+      // Для блока собираем строки и столбцы кандидатов, для строки/столбца — блоки.
+      unsigned rows = 0;
+      unsigned cols = 0;
+      unsigned boxes = 0;
+      for (int i : units[u]) {
+        if (grid.GetCell(i) != 0 || (Candidates(grid, *elim, i) & bit) == 0) {
+          continue;
+        }
+        rows |= 1u << SudokuGrid::RowOf(i);
+        cols |= 1u << SudokuGrid::ColOf(i);
+        boxes |= 1u << SudokuGrid::BoxOf(i);
+      }
+      if (rows == 0) continue;
+
+      if (is_box) {
+        if (PopCount(rows) == 1) {
+          removed += EliminateOutside(grid, LowestBit(rows), u, bit, elim);
+        }
+        if (PopCount(cols) == 1) {
+          removed += EliminateOutside(grid, SudokuGrid::kSize + LowestBit(cols),
+                                      u, bit, elim);
+        }
+      } else if (PopCount(boxes) == 1) {
+        removed += EliminateOutside(
+            grid, 2 * SudokuGrid::kSize + LowestBit(boxes), u, bit, elim);
+      }
+    }
+  }
+
+  stats->locked_eliminations += removed;
+  return removed > 0 ? StepResult::kProgress : StepResult::kNoProgress;
+}
+
+bool HasEmptyCell(const SudokuGrid& grid) {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (grid.GetCell(i) == 0) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+PropagationResult Propagate(SudokuGrid* grid, PropagationStats* stats) {
+  EliminationMasks eliminations;
+  eliminations.fill(SudokuGrid::kAllDigits);
+  return Propagate(grid, &eliminations, stats);
+}
+
+PropagationResult Propagate(SudokuGrid* grid, EliminationMasks* eliminations,
+                            PropagationStats* stats) {
+  if (grid == nullptr || eliminations == nullptr) {
+    return PropagationResult::kContradiction;
+  }
+  if (grid->HasConflicts()) return PropagationResult::kContradiction;
+
+  PropagationStats local;
+  PropagationStats* s = stats != nullptr ? stats : &local;
+
+  // Сначала самые дешёвые приёмы; любой прогресс возвращает к началу.
+  while (true) {
+    StepResult step = ApplyNakedSingles(grid, *eliminations, s);
+    if (step == StepResult::kContradiction) return PropagationResult::kContradiction;
+    if (step == StepResult::kProgress) continue;
+
+    step = ApplyHiddenSingles(grid, *eliminations, s);
+    if (step == StepResult::kContradiction) return PropagationResult::kContradiction;
+    if (step == StepResult::kProgress) continue;
+
+    step = ApplyLockedCandidates(*grid, eliminations, s);
+    if (step == StepResult::kProgress) continue;
+    break;
+  }
+
+  return HasEmptyCell(*grid) ? PropagationResult::kStuck
+                             : PropagationResult::kSolved;
+}
+
+bool SolveWithPropagation(SudokuGrid* grid, PropagationStats* stats) {
+  return SolveWithPropagation(grid, stats, nullptr);
+}
+
+bool SolveWithPropagation(SudokuGrid* grid, PropagationStats* stats,
+                          SolveStats* search_stats) {
+  return SolveWithPropagation(grid, stats, SolveLimits(), search_stats) ==
+         SolveResult::kSolved;
+}
+
+SolveResult SolveWithPropagation(SudokuGrid* grid, PropagationStats* stats,
+                                 const SolveLimits& limits,
+                                 SolveStats* search_stats) {
+  if (grid == nullptr) return SolveResult::kUnsolvable;
+
+  ScopedSolveTimer timer(search_stats);
+  const SudokuGrid original = *grid;
+  PropagationStats local;
+  PropagationStats* s = stats != nullptr ? stats : &local;
+
+  const int singles_before = s->naked_singles + s->hidden_singles;
+  const PropagationResult result = Propagate(grid, s);
+  if (search_stats != nullptr) {
+    search_stats->propagation_hits +=
+        s->naked_singles + s->hidden_singles - singles_before;
+  }
+  if (result == PropagationResult::kSolved) return SolveResult::kSolved;
+  if (result == PropagationResult::kContradiction) {
+    *grid = original;
+    return SolveResult::kUnsolvable;
+  }
+
+  int empty = 0;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    if (grid->GetCell(i) == 0) ++empty;
+  }
+  // Время уже учитывает timer, из search берутся только счётчики.
+  SolveStats search;
+  const SolveResult solved =
+      SolveIterative(grid, CellOrder::kMinRemaining, limits, &search);
+  if (search_stats != nullptr) {
+    search_stats->nodes += search.nodes;
+    search_stats->backtracks += search.backtracks;
+    search_stats->propagation_hits += search.propagation_hits;
+    if (search.max_depth > search_stats->max_depth) {
+      search_stats->max_depth = search.max_depth;
+    }
+  }
+  if (solved != SolveResult::kSolved) {
+    *grid = original;
+    return solved;
+  }
+  s->search_cells += empty;
+  return SolveResult::kSolved;
+}
+
+const char* TechniqueName(Technique technique) {
+  switch (technique) {
+    case Technique::kNakedSingle:
+      return "naked single";
+    case Technique::kHiddenSingle:
+      return "hidden single";
+    case Technique::kLockedCandidates:
+      return "locked candidates";
+  }
+  return "?";
+}
+
+}  // namespace sudoku
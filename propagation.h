@@ -0,0 +1,61 @@
+#ifndef SUDOKU_PROPAGATION_H_
+#define SUDOKU_PROPAGATION_H_
+
+#include <array>
+#include <cstdint>
+
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Логические приёмы в порядке возрастания сложности.
+enum class Technique {
+  kNakedSingle,       // В клетке остался один кандидат.
+  kHiddenSingle,      // Цифре осталось одно место в строке/столбце/блоке.
+  kLockedCandidates,  // Pointing/claiming: пересечение блока со строкой/столбцом.
+};
+
+const char* TechniqueName(Technique technique);
+
+// Сколько клеток решил каждый приём. Locked candidates клеток сами не
+// заполняют, поэтому для них считается число исключённых кандидатов.
+struct PropagationStats {
+  int naked_singles = 0;
+  int hidden_singles = 0;
+  int locked_eliminations = 0;
+  int search_cells = 0;  // Клетки, заполненные перебором после неподвижной точки.
+};
+
+enum class PropagationResult {
+  kSolved,         // Все клетки заполнены.
+  kStuck,          // Неподвижная точка: приёмы больше ничего не дают.
+  kContradiction,  // Клетке или цифре в группе не осталось места.
+};
+
+// Кандидаты, исключённые сверх масок поля: бит v сброшен, если цифра v
+// запрещена в клетке локальными рассуждениями (locked candidates).
+using EliminationMasks = std::array<std::uint16_t, SudokuGrid::kCellCount>;
+
+// Применяет naked singles, hidden singles и locked candidates до неподвижной
+// точки. Заполняет клетки поля; stats может быть nullptr.
+PropagationResult Propagate(SudokuGrid* grid, PropagationStats* stats);
+PropagationResult Propagate(SudokuGrid* grid, EliminationMasks* eliminations,
+                            PropagationStats* stats);
+
+// Распространение ограничений, затем SolveIterative (MRV) для оставшихся
+// клеток. При неудаче поле остаётся в исходном состоянии.
+bool SolveWithPropagation(SudokuGrid* grid, PropagationStats* stats);
+// То же с общими счётчиками решателя: клетки, заполненные приёмами,
+// идут в search_stats->propagation_hits, перебор — в остальные поля.
+bool SolveWithPropagation(SudokuGrid* grid, PropagationStats* stats,
+                          SolveStats* search_stats);
+// То же с ограничениями на перебор (сами приёмы полиномиальны и
+// не ограничиваются). Кроме kSolved поле остаётся исходным.
+SolveResult SolveWithPropagation(SudokuGrid* grid, PropagationStats* stats,
+                                 const SolveLimits& limits,
+                                 SolveStats* search_stats);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_PROPAGATION_H_
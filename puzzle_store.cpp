@@ -0,0 +1,325 @@
+#include "puzzle_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+#include "canonical.h"
+
+namespace sudoku {
+namespace {
+
+constexpr char kMagic[8] = {'S', 'D', 'K', 'S', 'T', 'O', 'R', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint64_t kCanonicalKeysFlag = 1;
+constexpr int kHeaderSize = 32;
+constexpr std::size_t kInitialSlots = 1 << 10;
+constexpr std::size_t kLoadBlock = 1 << 12;  // Записей за одно чтение.
+// Номер записи + 1 хранится в 32 битах слота.
+constexpr std::size_t kMaxRecords =
+    std::numeric_limits<std::uint32_t>::max() - 1;
+
+void BuildHeader(std::uint64_t count, bool canonical_keys,
+                 std::size_t record_size, std::uint8_t* header) {
+  std::memset(header, 0, kHeaderSize);
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  PutLittleEndian(kVersion, 4, header + 8);
+  PutLittleEndian(record_size, 4, header + 12);
+  PutLittleEndian(count, 8, header + 16);
+  PutLittleEndian(canonical_keys ? kCanonicalKeysFlag : 0, 8, header + 24);
+}
+
+// Хэш 41-байтного ключа словами по 8 байт (SplitMix-подобное смешивание).
+// На диск не пишется, поэтому порядок байтов машины не важен.
+std::uint64_t HashKey(const std::uint8_t* key) {
+  std::uint64_t h = 0x9E3779B97F4A7C15ull;
+  for (int k = 0; k < kPackedGridSize; k += 8) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, key + k, std::min(8, kPackedGridSize - k));
+    h = (h ^ word) * 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 31;
+  }
+  return h * 0x94D049BB133111EBull;
+}
+
+// Решение подходит к задаче: поле заполнено без повторов и совпадает с
+// задачей во всех её клетках.
+bool SolutionFits(const SudokuGrid& puzzle, const SudokuGrid& solution) {
+  if (!solution.IsComplete() || solution.HasConflicts()) return false;
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    const int v = puzzle.GetCell(i);
+    if (v != 0 && v != solution.GetCell(i)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+PuzzleStore::~PuzzleStore() {
+  if (file_.is_open()) Close(nullptr);
+}
+
+bool PuzzleStore::Open(const std::string& path, bool canonical_keys,
+                       std::string* error) {
+  if (file_.is_open()) Close(nullptr);
+  canonical_keys_ = canonical_keys;
+  at_end_ = false;
+  count_ = 0;
+  keys_.clear();
+  slots_.assign(kInitialSlots, Slot());
+
+  file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+  if (!file_.is_open()) {
+    // Файла нет: создаём пустой и открываем заново на чтение и запись.
+    std::ofstream create(path, std::ios::binary);
+    if (!create.is_open()) {
+      if (error) *error = "не удалось создать файл хранилища";
+      return false;
+    }
+    create.close();
+    file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file_.is_open()) {
+      if (error) *error = "не удалось открыть файл хранилища";
+      return false;
+    }
+  }
+
+  file_.seekg(0, std::ios::end);
+  const std::uint64_t length = static_cast<std::uint64_t>(file_.tellg());
+  std::uint8_t header[kHeaderSize];
+  if (length == 0) {
+    BuildHeader(0, canonical_keys_, record_size(), header);
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(header), kHeaderSize);
+    if (!file_.good()) {
+      file_.close();
+      if (error) *error = "ошибка записи в файл";
+      return false;
+    }
+    if (error) *error = "";
+    return true;
+  }
+
+  file_.seekg(0);
+  file_.read(reinterpret_cast<char*>(header), kHeaderSize);
+  if (!file_.good() || std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+      GetLittleEndian(header + 8, 4) != kVersion) {
+    file_.close();
+    if (error) *error = "файл не является хранилищем задач";
+    return false;
+  }
+  const bool stored_canonical =
+      (GetLittleEndian(header + 24, 8) & kCanonicalKeysFlag) != 0;
+  if (stored_canonical != canonical_keys_) {
+    file_.close();
+    if (error) {
+      *error = stored_canonical
+                   ? "хранилище создано с каноническими ключами"
+                   : "хранилище создано без канонических ключей";
+    }
+    return false;
+  }
+  const std::size_t size = record_size();
+  if (GetLittleEndian(header + 12, 4) != size) {
+    file_.close();
+    if (error) *error = "файл не является хранилищем задач";
+    return false;
+  }
+
+  // Записи, дописанные после последнего Close (например, до сбоя), тоже
+  // принимаются: число в заголовке может только отставать. Неполная
+  // последняя запись (сбой посреди дописывания) отрезается, чтобы новые
+  // записи шли с границы записи.
+  const std::uint64_t body = length - kHeaderSize;
+  const std::uint64_t records = body / size;
+  if (body % size != 0) {
+    file_.close();
+    std::error_code resize_error;
+    std::filesystem::resize_file(path, kHeaderSize + records * size,
+                                 resize_error);
+    if (resize_error) {
+      if (error) *error = "не удалось отрезать неполную последнюю запись";
+      return false;
+    }
+    file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file_.is_open()) {
+      if (error) *error = "не удалось открыть файл хранилища";
+      return false;
+    }
+    file_.seekg(kHeaderSize);
+  }
+  if (GetLittleEndian(header + 16, 8) > records) {
+    file_.close();
+    if (error) *error = "хранилище обрезано: записей меньше, чем в заголовке";
+    return false;
+  }
+  if (records > kMaxRecords) {
+    file_.close();
+    if (error) *error = "слишком много записей в хранилище";
+    return false;
+  }
+
+  std::size_t slot_count = kInitialSlots;
+  while (slot_count < 2 * records + 2) slot_count *= 2;
+  slots_.assign(slot_count, Slot());
+  keys_.resize(static_cast<std::size_t>(records) * kPackedGridSize);
+
+  const std::size_t key_offset = canonical_keys_ ? 2 * kPackedGridSize : 0;
+  std::vector<std::uint8_t> block(kLoadBlock * size);
+  while (count_ < records) {
+    const std::size_t n = static_cast<std::size_t>(
+        std::min<std::uint64_t>(kLoadBlock, records - count_));
+    file_.read(reinterpret_cast<char*>(block.data()),
+               static_cast<std::streamsize>(n * size));
+    if (!file_.good()) {
+      file_.close();
+      if (error) *error = "ошибка чтения хранилища";
+      return false;
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+      std::memcpy(keys_.data() + count_ * kPackedGridSize,
+                  block.data() + k * size + key_offset, kPackedGridSize);
+      // Повтор в самом файле (дописан не через PuzzleStore) не индексируется:
+      // Find находит первую запись.
+      AddToIndex(count_);
+      ++count_;
+    }
+  }
+
+  if (error) *error = "";
+  return true;
+}
+
+bool PuzzleStore::Close(std::string* error) {
+  if (!file_.is_open()) {
+    if (error) *error = "файл не открыт";
+    return false;
+  }
+
+  std::uint8_t header[kHeaderSize];
+  BuildHeader(count_, canonical_keys_, record_size(), header);
+  file_.seekp(0);
+  file_.write(reinterpret_cast<const char*>(header), kHeaderSize);
+  file_.flush();
+  const bool ok = file_.good();
+  file_.close();
+  count_ = 0;
+  keys_.clear();
+  slots_.clear();
+
+  if (!ok) {
+    if (error) *error = "ошибка записи в файл";
+    return false;
+  }
+  if (error) *error = "";
+  return true;
+}
+
+PuzzleStore::Key PuzzleStore::KeyOf(const SudokuGrid& puzzle) const {
+  Key key;
+  if (canonical_keys_ && !puzzle.HasConflicts()) {
+    PackGrid(CanonicalForm(puzzle, nullptr), key.data());
+  } else {
+    PackGrid(puzzle, key.data());
+  }
+  return key;
+}
+
+std::size_t PuzzleStore::Probe(const std::uint8_t* key,
+                               std::uint64_t hash) const {
+  const std::size_t mask = slots_.size() - 1;
+  const std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32);
+  for (std::size_t s = static_cast<std::size_t>(hash) & mask;;
+       s = (s + 1) & mask) {
+    const Slot& slot = slots_[s];
+    if (slot.index == 0) return s;
+    if (slot.tag == tag &&
+        std::memcmp(KeyAt(slot.index - 1), key, kPackedGridSize) == 0) {
+      return s;
+    }
+  }
+}
+
+bool PuzzleStore::AddToIndex(std::size_t index) {
+  const std::uint64_t hash = HashKey(KeyAt(index));
+  Slot& slot = slots_[Probe(KeyAt(index), hash)];
+  if (slot.index != 0) return false;
+  slot.tag = static_cast<std::uint32_t>(hash >> 32);
+  slot.index = static_cast<std::uint32_t>(index + 1);
+  return true;
+}
+
+void PuzzleStore::Grow() {
+  std::vector<Slot> old(slots_.size() * 2);
+  old.swap(slots_);
+  for (const Slot& slot : old) {
+    if (slot.index != 0) AddToIndex(slot.index - 1);
+  }
+}
+
+bool PuzzleStore::Find(const Key& key, std::size_t* index) const {
+  if (slots_.empty()) return false;
+  const Slot& slot = slots_[Probe(key.data(), HashKey(key.data()))];
+  if (slot.index == 0) return false;
+  if (index != nullptr) *index = slot.index - 1;
+  return true;
+}
+
+StoreInsert PuzzleStore::Insert(const Key& key, const SudokuGrid& puzzle,
+                                const SudokuGrid* solution) {
+  if (!file_.is_open()) return StoreInsert::kIoError;
+  if (puzzle.HasConflicts() ||
+      (solution != nullptr && !SolutionFits(puzzle, *solution))) {
+    return StoreInsert::kInvalid;
+  }
+  if (Find(key, nullptr)) return StoreInsert::kDuplicate;
+  if (count_ >= kMaxRecords) return StoreInsert::kIoError;
+
+  std::uint8_t record[3 * kPackedGridSize] = {};
+  PackGrid(puzzle, record);
+  if (solution != nullptr) PackGrid(*solution, record + kPackedGridSize);
+  if (canonical_keys_) {
+    std::memcpy(record + 2 * kPackedGridSize, key.data(), kPackedGridSize);
+  }
+  // Переход к концу файла сбрасывает буфер записи, поэтому делается только
+  // после чтения (Open, Get): подряд идущие записи уходят одним блоком.
+  if (!at_end_) {
+    file_.seekp(0, std::ios::end);
+    at_end_ = true;
+  }
+  file_.write(reinterpret_cast<const char*>(record),
+              static_cast<std::streamsize>(record_size()));
+  if (!file_.good()) return StoreInsert::kIoError;
+
+  keys_.insert(keys_.end(), key.begin(), key.end());
+  if (2 * (count_ + 1) > slots_.size()) Grow();
+  AddToIndex(count_);
+  ++count_;
+  return StoreInsert::kAdded;
+}
+
+bool PuzzleStore::Get(std::size_t index, SudokuGrid* puzzle,
+                      SudokuGrid* solution) {
+  if (!file_.is_open() || index >= count_) return false;
+
+  std::uint8_t record[2 * kPackedGridSize];
+  at_end_ = false;
+  file_.seekg(static_cast<std::streamoff>(kHeaderSize) +
+              static_cast<std::streamoff>(index * record_size()));
+  file_.read(reinterpret_cast<char*>(record), sizeof(record));
+  if (!file_.good()) {
+    file_.clear();
+    return false;
+  }
+  SudokuGrid p;
+  SudokuGrid s;
+  if (!UnpackGrid(record, &p) || !UnpackGrid(record + kPackedGridSize, &s)) {
+    return false;
+  }
+  if (puzzle != nullptr) *puzzle = p;
+  if (solution != nullptr) *solution = s;
+  return true;
+}
+
+}  // namespace sudoku
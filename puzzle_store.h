@@ -0,0 +1,106 @@
+#ifndef SUDOKU_PUZZLE_STORE_H_
+#define SUDOKU_PUZZLE_STORE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+enum class StoreInsert {
+  kAdded,
+  kDuplicate,  // Задача (с canonical_keys — эквивалентная) уже в хранилище.
+  kInvalid,    // Повторы в задаче или решение не подходит к задаче.
+  kIoError,
+};
+
+// Архив задач на диске без повторов:
+//   заголовок 32 байта: "SDKSTOR1", версия (u32), размер записи (u32),
+//   число записей (u64), флаги (u64, бит 0 — ключи по канонической форме);
+//   далее записи: задача и решение в формате PackGrid (corpus.h), при
+//   канонических ключах — ещё и ключ; нули вместо решения — оно не записано.
+// Ключ записи — PackGrid самой задачи или её канонической формы
+// (canonical.h): тогда повтором считается и любая эквивалентная задача.
+// Индекс — открытая адресация по хэшу ключа в памяти: поиск и добавление
+// за O(1) без обращения к диску. Open строит индекс одним чтением файла
+// (ключи лежат в записях, каноническая форма заново не считается); в
+// памяти — 57–73 байта на запись. Записи только дописываются в конец.
+// Не потокобезопасен; KeyOf можно вызывать из нескольких потоков.
+class PuzzleStore {
+ public:
+  using Key = std::array<std::uint8_t, kPackedGridSize>;
+
+  PuzzleStore() = default;
+  ~PuzzleStore();
+  PuzzleStore(const PuzzleStore&) = delete;
+  PuzzleStore& operator=(const PuzzleStore&) = delete;
+
+  // Открывает хранилище или создаёт пустое. canonical_keys должен совпадать
+  // с тем, с которым хранилище создано. Неполная последняя запись (обрыв
+  // дописывания) отрезается от файла.
+  bool Open(const std::string& path, bool canonical_keys, std::string* error);
+  // Записывает число записей в заголовок и закрывает файл.
+  bool Close(std::string* error);
+
+  bool canonical_keys() const { return canonical_keys_; }
+  std::size_t size() const { return count_; }
+
+  // Ключ задачи (для задачи с повторами — всегда PackGrid самой задачи).
+  Key KeyOf(const SudokuGrid& puzzle) const;
+
+  // Номер записи с ключом key.
+  bool Find(const Key& key, std::size_t* index) const;
+  bool Find(const SudokuGrid& puzzle, std::size_t* index) const {
+    return Find(KeyOf(puzzle), index);
+  }
+
+  // Добавляет задачу, если ключа ещё нет. solution может быть nullptr;
+  // иначе это заполненное поле без повторов, совпадающее с задачей в её
+  // клетках.
+  StoreInsert Insert(const SudokuGrid& puzzle, const SudokuGrid* solution) {
+    return Insert(KeyOf(puzzle), puzzle, solution);
+  }
+  // То же с заранее посчитанным key == KeyOf(puzzle) (например, в
+  // нескольких потоках).
+  StoreInsert Insert(const Key& key, const SudokuGrid& puzzle,
+                     const SudokuGrid* solution);
+
+  // Задача и решение записи index (solution — пустое поле, если решение не
+  // записано); любой из указателей может быть nullptr.
+  bool Get(std::size_t index, SudokuGrid* puzzle, SudokuGrid* solution);
+
+ private:
+  struct Slot {
+    std::uint32_t tag = 0;    // Старшие биты хэша ключа.
+    std::uint32_t index = 0;  // Номер записи + 1; 0 — слот пуст.
+  };
+
+  const std::uint8_t* KeyAt(std::size_t index) const {
+    return keys_.data() + index * kPackedGridSize;
+  }
+  // Слот с ключом key или первый пустой на его пути.
+  std::size_t Probe(const std::uint8_t* key, std::uint64_t hash) const;
+  // Вносит в индекс запись index (ключ уже в keys_); false — повтор.
+  bool AddToIndex(std::size_t index);
+  void Grow();
+  std::size_t record_size() const {
+    return (canonical_keys_ ? 3 : 2) * kPackedGridSize;
+  }
+
+  std::fstream file_;
+  bool canonical_keys_ = false;
+  bool at_end_ = false;  // Позиция записи — конец файла.
+  std::size_t count_ = 0;
+  std::vector<std::uint8_t> keys_;  // По kPackedGridSize байт на запись.
+  std::vector<Slot> slots_;         // Размер — степень двойки.
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_PUZZLE_STORE_H_
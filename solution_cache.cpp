@@ -0,0 +1,95 @@
+#include "solution_cache.h"
+
+#include <utility>
+
+#include "canonical.h"
+#include "corpus.h"
+#include "propagation.h"
+
+namespace sudoku {
+namespace {
+
+std::string PackedKey(const SudokuGrid& grid) {
+  std::string key(kPackedGridSize, '\0');
+  PackGrid(grid, reinterpret_cast<std::uint8_t*>(&key[0]));
+  return key;
+}
+
+}  // namespace
+
+SolutionCache::SolutionCache(std::size_t capacity)
+    : capacity_(capacity == 0 ? 1 : capacity) {
+  index_.reserve(capacity_);
+}
+
+bool SolutionCache::Solve(SudokuGrid* grid, SolveFunction solve,
+                          SolveStats* stats) {
+  if (grid == nullptr) return false;
+  if (grid->HasConflicts()) {
+    return solve != nullptr ? solve(grid, stats)
+                            : SolveWithPropagation(grid, nullptr, stats);
+  }
+
+  GridTransform transform;
+  const SudokuGrid canonical = CanonicalForm(*grid, &transform);
+  Entry entry;
+  entry.key = PackedKey(canonical);
+  if (Find(entry.key, &entry)) {
+    if (!entry.solved) return false;
+    *grid = ApplyInverseTransform(entry.solution, transform);
+    return true;
+  }
+
+  SudokuGrid work = *grid;
+  entry.solved = solve != nullptr ? solve(&work, stats)
+                                  : SolveWithPropagation(&work, nullptr, stats);
+  entry.solution = entry.solved ? ApplyTransform(work, transform) : canonical;
+  const bool solved = entry.solved;
+  Insert(std::move(entry));
+  if (solved) *grid = work;
+  return solved;
+}
+
+bool SolutionCache::Find(const std::string& key, Entry* entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return false;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  entry->solved = it->second->solved;
+  entry->solution = it->second->solution;
+  return true;
+}
+
+void SolutionCache::Insert(Entry entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Ту же задачу мог параллельно решить другой поток.
+  if (index_.count(entry.key) != 0) return;
+
+  entries_.push_front(std::move(entry));
+  index_.emplace(entries_.front().key, entries_.begin());
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+std::uint64_t SolutionCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+std::uint64_t SolutionCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+std::size_t SolutionCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace sudoku
@@ -0,0 +1,59 @@
+#ifndef SUDOKU_SOLUTION_CACHE_H_
+#define SUDOKU_SOLUTION_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "batch.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Ограниченный кэш решений (вытесняется давно не использованное) с ключом —
+// канонической формой задачи (canonical.h): повтор задачи и любая
+// эквивалентная ей (перестановка цифр, строк, столбцов, полос, стеков,
+// транспонирование) решаются один раз. Хранится решение канонической
+// формы; при попадании оно переводится в ориентацию запроса. Нерешаемые
+// задачи тоже запоминаются. Потокобезопасен: каноническая форма и решение
+// считаются вне блокировки, под мьютексом — только поиск и вставка.
+class SolutionCache {
+ public:
+  explicit SolutionCache(std::size_t capacity);
+  SolutionCache(const SolutionCache&) = delete;
+  SolutionCache& operator=(const SolutionCache&) = delete;
+
+  // Решение grid через кэш; при промахе вызывается solve (nullptr —
+  // SolveWithPropagation) и результат сохраняется. stats заполняется
+  // только при промахе. Поле с повторами решается без кэша.
+  bool Solve(SudokuGrid* grid, SolveFunction solve, SolveStats* stats);
+
+  std::uint64_t hits() const;
+  std::uint64_t misses() const;
+  std::size_t size() const;
+
+ private:
+  struct Entry {
+    std::string key;  // PackGrid канонической формы.
+    bool solved = false;
+    SudokuGrid solution;  // В канонической ориентации.
+  };
+
+  // Под мьютексом: поиск с переносом в начало списка.
+  bool Find(const std::string& key, Entry* entry);
+  void Insert(Entry entry);
+
+  const std::size_t capacity_;
+  mutable std::mutex mutex_;
+  std::list<Entry> entries_;  // Начало — недавно использованные.
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  std::uint64_t hits_ = 0;
+  std::uint64_t misses_ = 0;
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_SOLUTION_CACHE_H_
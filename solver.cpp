@@ -1,107 +1,38 @@
 #include "solver.h"
 
 #include <array>
-#include <vector>
+#include <cstdint>
+
+#include "bits.h"
+#include "solver_search.h"
 
 namespace sudoku {
 namespace {
 
-int BoxIndex(int row, int col) {
-  return (row / 3) * 3 + (col / 3);
-}
-
-// Маски строк/столбцов/блоков: бит v установлен, если цифра v уже присутствует.
-// Это ускоряет проверки и делает итеративный бэктрекинг простым.
-bool BuildMasks(const SudokuGrid& grid, std::array<int, 9>* row_mask,
-                std::array<int, 9>* col_mask, std::array<int, 9>* box_mask) {
-  row_mask->fill(0);
-  col_mask->fill(0);
-  box_mask->fill(0);
-
-  for (int r = 0; r < SudokuGrid::kSize; ++r) {
-    for (int c = 0; c < SudokuGrid::kSize; ++c) {
-      const int v = grid.Get(r, c);
-      if (v == 0) continue;
-
-      const int bit = 1 << v;
-      const int b = BoxIndex(r, c);
-
-      if (((*row_mask)[r] & bit) != 0 || ((*col_mask)[c] & bit) != 0 ||
-          ((*box_mask)[b] & bit) != 0) {
-        return false;
-      }
-
-      (*row_mask)[r] |= bit;
-      (*col_mask)[c] |= bit;
-      (*box_mask)[b] |= bit;
-    }
-  }
-  return true;
-}
-
-bool IsAllowed(const std::array<int, 9>& row_mask, const std::array<int, 9>& col_mask,
-               const std::array<int, 9>& box_mask, int row, int col, int value) {
-  const int bit = 1 << value;
-  const int b = BoxIndex(row, col);
-  return (row_mask[row] & bit) == 0 && (col_mask[col] & bit) == 0 &&
-         (box_mask[b] & bit) == 0;
-}
-
-void Place(std::array<int, 9>* row_mask, std::array<int, 9>* col_mask,
-           std::array<int, 9>* box_mask, SudokuGrid* grid, int row, int col,
-           int value) {
-  const int bit = 1 << value;
-  const int b = BoxIndex(row, col);
-
-  (*row_mask)[row] |= bit;
-  (*col_mask)[col] |= bit;
-  (*box_mask)[b] |= bit;
-
-  grid->Set(row, col, value);
-}
-
-void Unplace(std::array<int, 9>* row_mask, std::array<int, 9>* col_mask,
-             std::array<int, 9>* box_mask, SudokuGrid* grid, int row, int col) {
-  const int value = grid->Get(row, col);
-  if (value == 0) return;
-
-  const int bit = 1 << value;
-  const int b = BoxIndex(row, col);
-
-  (*row_mask)[row] &= ~bit;
-  (*col_mask)[col] &= ~bit;
-  (*box_mask)[b] &= ~bit;
-
-  grid->Set(row, col, 0);
-}
-
-}  // namespace
-
-bool SolveIterative(SudokuGrid* grid) {
-  if (grid == nullptr) return false;
-
-  std::array<int, 9> row_mask{};
-  std::array<int, 9> col_mask{};
-  std::array<int, 9> box_mask{};
-  if (!BuildMasks(*grid, &row_mask, &col_mask, &box_mask)) {
-    return false;
-  }
-
-  std::vector<int> empties;
-  empties.reserve(SudokuGrid::kCellCount);
-  for (int r = 0; r < SudokuGrid::kSize; ++r) {
-    for (int c = 0; c < SudokuGrid::kSize; ++c) {
-      if (grid->Get(r, c) == 0) {
-        empties.push_back(r * SudokuGrid::kSize + c);
-      }
+// Маски строк/столбцов/блоков поддерживает сам SudokuGrid: бит v установлен,
+// если цифра v уже присутствует. Поэтому проверка «можно ли поставить» —
+// одна операция над CandidateMask, а постановка/снятие цифры обновляет
+// маски инкрементально.
+template <int kBox>
+bool SearchRowMajor(BasicSudokuGrid<kBox>* grid, SolveStats* stats,
+                    SearchBudget* budget) {
+  using Grid = BasicSudokuGrid<kBox>;
+
+  // Стек фиксированного размера: перебор не выделяет память.
+  std::array<int, Grid::kCellCount> empties{};
+  int empty_count = 0;
+  for (int i = 0; i < Grid::kCellCount; ++i) {
+    if (grid->GetCell(i) == 0) {
+      empties[empty_count++] = i;
     }
   }
 
-  std::vector<int> next_value(empties.size(), 1);
+  std::array<int, Grid::kCellCount> next_value;
+  next_value.fill(1);
   int pos = 0;
 
   while (true) {
-    if (pos == static_cast<int>(empties.size())) {
+    if (pos == empty_count) {
       return true;
     }
     if (pos < 0) {
@@ -109,15 +40,18 @@ bool SolveIterative(SudokuGrid* grid) {
     }
 
     const int idx = empties[pos];
-    const int r = idx / SudokuGrid::kSize;
-    const int c = idx % SudokuGrid::kSize;
+    const unsigned allowed = grid->CandidateMask(idx);
 
     bool placed = false;
-    for (int v = next_value[pos]; v <= 9; ++v) {
-      if (IsAllowed(row_mask, col_mask, box_mask, r, c, v)) {
-        Place(&row_mask, &col_mask, &box_mask, grid, r, c, v);
+    for (int v = next_value[pos]; v <= Grid::kSize; ++v) {
+      if ((allowed & (1u << v)) != 0) {
+        if (budget->Spend()) return false;
+        grid->SetCell(idx, v);
+        ++stats->nodes;
+        if (PopCount(allowed) == 1) ++stats->propagation_hits;
         next_value[pos] = v + 1;
         ++pos;
+        if (pos > stats->max_depth) stats->max_depth = pos;
         placed = true;
         break;
       }
@@ -129,11 +63,102 @@ bool SolveIterative(SudokuGrid* grid) {
     if (pos == 0) return false;
 
     --pos;
-    const int back_idx = empties[pos];
-    const int br = back_idx / SudokuGrid::kSize;
-    const int bc = back_idx % SudokuGrid::kSize;
-    Unplace(&row_mask, &col_mask, &box_mask, grid, br, bc);
+    grid->SetCell(empties[pos], 0);
+    ++stats->backtracks;
+  }
+}
+
+}  // namespace
+
+template <int kBox>
+bool SolveIterative(BasicSudokuGrid<kBox>* grid) {
+  return SolveIterative(grid, CellOrder::kRowMajor, nullptr);
+}
+
+template <int kBox>
+bool SolveIterative(BasicSudokuGrid<kBox>* grid, CellOrder order) {
+  return SolveIterative(grid, order, nullptr);
+}
+
+template <int kBox>
+bool SolveIterative(BasicSudokuGrid<kBox>* grid, CellOrder order,
+                    SolveStats* stats) {
+  if (grid == nullptr) return false;
+  if (grid->HasConflicts()) return false;
+
+  ScopedSolveTimer timer(stats);
+  SolveStats local;
+  SolveStats* s = stats != nullptr ? stats : &local;
+  SearchBudget unlimited;
+  if (order == CellOrder::kRowMajor) {
+    return SearchRowMajor(grid, s, &unlimited);
   }
+  return SearchMinRemaining(grid, 1, s, &unlimited) == 1;
+}
+
+template <int kBox>
+SolveResult SolveIterative(BasicSudokuGrid<kBox>* grid, CellOrder order,
+                           const SolveLimits& limits, SolveStats* stats) {
+  if (grid == nullptr) return SolveResult::kUnsolvable;
+  if (grid->HasConflicts()) return SolveResult::kUnsolvable;
+
+  ScopedSolveTimer timer(stats);
+  SolveStats local;
+  SolveStats* s = stats != nullptr ? stats : &local;
+  SearchBudget budget(&limits);
+  const BasicSudokuGrid<kBox> original = *grid;
+
+  const bool solved = order == CellOrder::kRowMajor
+                          ? SearchRowMajor(grid, s, &budget)
+                          : SearchMinRemaining(grid, 1, s, &budget) == 1;
+  if (solved) return SolveResult::kSolved;
+
+  // После полного перебора поле уже исходное; после остановки — нет.
+  *grid = original;
+  return budget.exhausted() ? SolveResult::kBudgetExhausted
+                            : SolveResult::kUnsolvable;
 }
 
+template <int kBox>
+int CountSolutions(const BasicSudokuGrid<kBox>& grid, int limit) {
+  if (limit <= 0) return 0;
+  if (grid.HasConflicts()) return 0;
+  BasicSudokuGrid<kBox> work = grid;
+  SolveStats stats;
+  SearchBudget unlimited;
+  return SearchMinRemaining(&work, limit, &stats, &unlimited);
+}
+
+template <int kBox>
+int CountSolutions(const BasicSudokuGrid<kBox>& grid, int limit,
+                   const SolveLimits& limits, SolveStats* stats) {
+  if (limit <= 0) return 0;
+  if (grid.HasConflicts()) return 0;
+
+  ScopedSolveTimer timer(stats);
+  SolveStats local;
+  SolveStats* s = stats != nullptr ? stats : &local;
+  BasicSudokuGrid<kBox> work = grid;
+  SearchBudget budget(&limits);
+  return SearchMinRemaining(&work, limit, s, &budget);
+}
+
+#define SUDOKU_INSTANTIATE_SOLVER(B)                                       \
+  template bool SolveIterative<B>(BasicSudokuGrid<B>* grid);               \
+  template bool SolveIterative<B>(BasicSudokuGrid<B>* grid,                \
+                                  CellOrder order);                        \
+  template bool SolveIterative<B>(BasicSudokuGrid<B>* grid,                \
+                                  CellOrder order, SolveStats* stats);     \
+  template SolveResult SolveIterative<B>(BasicSudokuGrid<B>* grid,         \
+                                         CellOrder order,                  \
+                                         const SolveLimits& limits,        \
+                                         SolveStats* stats);               \
+  template int CountSolutions<B>(const BasicSudokuGrid<B>& grid,           \
+                                 int limit);                               \
+  template int CountSolutions<B>(const BasicSudokuGrid<B>& grid,           \
+                                 int limit, const SolveLimits& limits,     \
+                                 SolveStats* stats);
+SUDOKU_FOR_EACH_BOX_SIZE(SUDOKU_INSTANTIATE_SOLVER)
+#undef SUDOKU_INSTANTIATE_SOLVER
+
 }  // namespace sudoku
@@ -1,12 +1,95 @@
 #ifndef SUDOKU_SOLVER_H_
 #define SUDOKU_SOLVER_H_
 
+#include <atomic>
+#include <chrono>
+
 #include "sudoku_grid.h"
 
 namespace sudoku {
 
-// Итеративный решатель без рекурсии.
-bool SolveIterative(SudokuGrid* grid);
+// Порядок перебора клеток в итеративном решателе.
+enum class CellOrder {
+  kRowMajor,      // Пустые клетки по порядку, цифры 1..9.
+  kMinRemaining,  // MRV: на каждом шаге клетка с наименьшим числом кандидатов.
+};
+
+// Счётчики перебора (накапливаются: вызывающий может суммировать их по
+// нескольким задачам; max_depth — максимум по всем вызовам).
+struct SolveStats {
+  long long nodes = 0;             // Поставленные перебором цифры.
+  long long backtracks = 0;        // Откаты: снятые перебором цифры.
+  long long propagation_hits = 0;  // Вынужденные ходы: выбора не было.
+  int max_depth = 0;               // Наибольшая глубина стека перебора.
+  double seconds = 0.0;            // Время внутри решателя.
+};
+
+// Добавляет время жизни объекта к stats->seconds; при stats == nullptr
+// часы не читаются вовсе.
+class ScopedSolveTimer {
+ public:
+  explicit ScopedSolveTimer(SolveStats* stats) : stats_(stats) {
+    if (stats_ != nullptr) start_ = std::chrono::steady_clock::now();
+  }
+  ~ScopedSolveTimer() {
+    if (stats_ == nullptr) return;
+    stats_->seconds += std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count();
+  }
+  ScopedSolveTimer(const ScopedSolveTimer&) = delete;
+  ScopedSolveTimer& operator=(const ScopedSolveTimer&) = delete;
+
+ private:
+  SolveStats* stats_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Ограничения на один вызов решателя; по умолчанию — без ограничений.
+struct SolveLimits {
+  long long max_nodes = 0;  // 0 — без ограничения числа узлов.
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+  const std::atomic<bool>* cancel = nullptr;  // true — прервать поиск.
+};
+
+enum class SolveResult {
+  kSolved,
+  kUnsolvable,       // Перебор завершён: решения нет.
+  kBudgetExhausted,  // Исчерпан лимит узлов, наступил срок или отмена.
+};
+
+// Итеративный решатель без рекурсии (порядок kRowMajor). stats может быть
+// nullptr; иначе к нему добавляются счётчики и время этого вызова.
+// Шаблон по размеру блока (см. SUDOKU_FOR_EACH_BOX_SIZE); для SudokuGrid
+// аргумент шаблона выводится сам.
+template <int kBox>
+bool SolveIterative(BasicSudokuGrid<kBox>* grid);
+template <int kBox>
+bool SolveIterative(BasicSudokuGrid<kBox>* grid, CellOrder order);
+template <int kBox>
+bool SolveIterative(BasicSudokuGrid<kBox>* grid, CellOrder order,
+                    SolveStats* stats);
+
+// Перебор с ограничениями. Узлы считаются точно; срок и флаг отмены
+// проверяются раз в kLimitCheckInterval узлов, поэтому реакция на них —
+// доли миллисекунды. При любом результате, кроме kSolved, поле остаётся
+// в исходном состоянии.
+constexpr int kLimitCheckInterval = 1024;
+template <int kBox>
+SolveResult SolveIterative(BasicSudokuGrid<kBox>* grid, CellOrder order,
+                           const SolveLimits& limits, SolveStats* stats);
+
+// Число решений, но не больше limit: поиск продолжается после первого
+// решения и останавливается, как только найдено limit решений. Для проверки
+// единственности достаточно limit = 2 (результат 1 — решение единственно).
+template <int kBox>
+int CountSolutions(const BasicSudokuGrid<kBox>& grid, int limit);
+// То же с ограничениями; при их исчерпании — число решений, найденных до
+// остановки (оценка снизу). stats может быть nullptr.
+template <int kBox>
+int CountSolutions(const BasicSudokuGrid<kBox>& grid, int limit,
+                   const SolveLimits& limits, SolveStats* stats);
 
 }  // namespace sudoku
 
@@ -0,0 +1,110 @@
+#ifndef SUDOKU_SOLVER_SEARCH_H_
+#define SUDOKU_SOLVER_SEARCH_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include "bits.h"
+#include "solver.h"
+
+// Внутренний заголовок: общий MRV-перебор solver.cpp и variants.cpp.
+
+namespace sudoku {
+
+// Учёт ограничений SolveLimits; без ограничений Spend() — одно сравнение.
+class SearchBudget {
+ public:
+  SearchBudget() = default;
+  explicit SearchBudget(const SolveLimits* limits) : limits_(limits) {}
+
+  // Вызывается перед каждым новым узлом; true — узел ставить нельзя.
+  bool Spend() {
+    if (limits_ == nullptr) return false;
+    ++nodes_;
+    if (limits_->max_nodes > 0 && nodes_ > limits_->max_nodes) {
+      exhausted_ = true;
+    } else if (--countdown_ == 0) {
+      countdown_ = kLimitCheckInterval;
+      if ((limits_->cancel != nullptr &&
+           limits_->cancel->load(std::memory_order_relaxed)) ||
+          std::chrono::steady_clock::now() >= limits_->deadline) {
+        exhausted_ = true;
+      }
+    }
+    return exhausted_;
+  }
+
+  bool exhausted() const { return exhausted_; }
+
+ private:
+  const SolveLimits* limits_ = nullptr;
+  long long nodes_ = 0;
+  int countdown_ = 1;  // Первая проверка срока — на первом же узле.
+  bool exhausted_ = false;
+};
+
+// MRV-перебор с явным стеком: в кадре хранится клетка и ещё не испробованные
+// кандидаты. Клетка выбирается заново на каждом шаге по popcount маски
+// кандидатов, поэтому вынужденные ходы (один кандидат) делаются сразу,
+// а тупики (ноль кандидатов) обнаруживаются до углубления.
+// Найденное решение засчитывается и, пока не достигнут limit, поиск
+// продолжается откатом, как из тупика. Возвращает число найденных решений
+// (не больше limit); при достижении limit поле содержит последнее решение.
+// Исчерпание бюджета останавливает поиск (см. budget->exhausted()).
+// Grid — BasicSudokuGrid или состояние с тем же интерфейсом: kCellCount,
+// kSize, Mask, GetCell, CandidateMask и SetCell (0 — снять цифру).
+template <typename Grid>
+int SearchMinRemaining(Grid* grid, int limit, SolveStats* stats,
+                       SearchBudget* budget) {
+  std::array<int, Grid::kCellCount> stack_cell{};
+  std::array<typename Grid::Mask, Grid::kCellCount> stack_rest{};
+  int depth = 0;
+  int found = 0;
+
+  while (true) {
+    int best = -1;
+    int best_count = Grid::kSize + 1;
+    for (int i = 0; i < Grid::kCellCount; ++i) {
+      if (grid->GetCell(i) != 0) continue;
+      const int n = PopCount(grid->CandidateMask(i));
+      if (n < best_count) {
+        best = i;
+        best_count = n;
+        if (n <= 1) break;
+      }
+    }
+    unsigned rest = 0;
+    bool forced = best_count == 1;
+    if (best < 0) {
+      if (++found >= limit) return found;
+    } else {
+      rest = grid->CandidateMask(best);
+    }
+
+    while (rest == 0) {
+      if (depth == 0) return found;
+      --depth;
+      best = stack_cell[depth];
+      rest = stack_rest[depth];
+      grid->SetCell(best, 0);
+      ++stats->backtracks;
+      forced = false;
+    }
+
+    if (budget->Spend()) return found;
+    const int v = LowestBit(rest);
+    rest &= rest - 1;
+    grid->SetCell(best, v);
+    stack_cell[depth] = best;
+    stack_rest[depth] = static_cast<typename Grid::Mask>(rest);
+    ++depth;
+    ++stats->nodes;
+    if (forced) ++stats->propagation_hits;
+    if (depth > stats->max_depth) stats->max_depth = depth;
+  }
+}
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_SOLVER_SEARCH_H_
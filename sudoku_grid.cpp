@@ -1,84 +1,202 @@
 #include "sudoku_grid.h"
 
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
 namespace sudoku {
-namespace {
 
-int BoxIndex(int row, int col) {
-  return (row / 3) * 3 + (col / 3);
+char ValueToChar(int value) {
+  if (value <= 0) return '.';
+  if (value <= 9) return static_cast<char>('0' + value);
+  return static_cast<char>('A' + value - 10);
 }
 
-}  // namespace
+int CharToValue(char ch) {
+  if (ch == '.' || ch == '0') return 0;
+  if (ch >= '1' && ch <= '9') return ch - '0';
+  if (ch >= 'A' && ch <= 'P') return ch - 'A' + 10;
+  if (ch >= 'a' && ch <= 'p') return ch - 'a' + 10;
+  return -1;
+}
 
-SudokuGrid::SudokuGrid() : cells_{} {
+template <int kBox>
+BasicSudokuGrid<kBox>::BasicSudokuGrid()
+    : cells_{}, row_mask_{}, col_mask_{}, box_mask_{}, has_conflicts_(false) {
   cells_.fill(0);
+  row_mask_.fill(0);
+  col_mask_.fill(0);
+  box_mask_.fill(0);
 }
 
-int SudokuGrid::Get(int row, int col) const {
-  return cells_.at(row * kSize + col);
+template <int kBox>
+int BasicSudokuGrid<kBox>::Get(int row, int col) const {
+  if (row < 0 || row >= kSize || col < 0 || col >= kSize) {
+    throw std::out_of_range("SudokuGrid::Get: клетка вне поля");
+  }
+  return cells_[row * kSize + col];
 }
 
-void SudokuGrid::Set(int row, int col, int value) {
-  cells_.at(row * kSize + col) = value;
+template <int kBox>
+void BasicSudokuGrid<kBox>::Set(int row, int col, int value) {
+  if (row < 0 || row >= kSize || col < 0 || col >= kSize) {
+    throw std::out_of_range("SudokuGrid::Set: клетка вне поля");
+  }
+  if (value < 0 || value > kSize) {
+    throw std::out_of_range("SudokuGrid::Set: значение вне диапазона 0.." +
+                            std::to_string(kSize));
+  }
+  SetCell(row * kSize + col, value);
 }
 
-void SudokuGrid::Clear(int row, int col) {
+template <int kBox>
+void BasicSudokuGrid<kBox>::Clear(int row, int col) {
   Set(row, col, 0);
 }
 
-bool SudokuGrid::IsComplete() const {
+template <int kBox>
+void BasicSudokuGrid<kBox>::SetCell(int index, int value) {
+  const int old = cells_[index];
+  if (old == value) return;
+  cells_[index] = static_cast<std::uint8_t>(value);
+
+  if (has_conflicts_) {
+    RebuildMasks();
+    return;
+  }
+
+  const int r = RowOf(index);
+  const int c = ColOf(index);
+  const int b = BoxIndex(r, c);
+
+  if (old != 0) {
+    const Mask keep = static_cast<Mask>(~(1u << old));
+    row_mask_[r] &= keep;
+    col_mask_[c] &= keep;
+    box_mask_[b] &= keep;
+  }
+  if (value != 0) {
+    const Mask bit = static_cast<Mask>(1u << value);
+    if (((row_mask_[r] | col_mask_[c] | box_mask_[b]) & bit) != 0) {
+      has_conflicts_ = true;
+    }
+    row_mask_[r] |= bit;
+    col_mask_[c] |= bit;
+    box_mask_[b] |= bit;
+  }
+}
+
+template <int kBox>
+void BasicSudokuGrid<kBox>::RebuildMasks() {
+  row_mask_.fill(0);
+  col_mask_.fill(0);
+  box_mask_.fill(0);
+  has_conflicts_ = false;
+
+  for (int i = 0; i < kCellCount; ++i) {
+    const int v = cells_[i];
+    if (v == 0) continue;
+
+    const Mask bit = static_cast<Mask>(1u << v);
+    const int r = RowOf(i);
+    const int c = ColOf(i);
+    const int b = BoxIndex(r, c);
+    if (((row_mask_[r] | col_mask_[c] | box_mask_[b]) & bit) != 0) {
+      has_conflicts_ = true;
+    }
+    row_mask_[r] |= bit;
+    col_mask_[c] |= bit;
+    box_mask_[b] |= bit;
+  }
+}
+
+template <int kBox>
+bool BasicSudokuGrid<kBox>::IsComplete() const {
   for (int i = 0; i < kCellCount; ++i) {
     if (cells_[i] == 0) return false;
   }
   return true;
 }
 
-std::string SudokuGrid::ToCompactString() const {
+template <int kBox>
+std::string BasicSudokuGrid<kBox>::ToCompactString() const {
   std::string out;
   out.reserve(kCellCount);
-  for (int i = 0; i < kCellCount; ++i) {
-    const int v = cells_[i];
-    out.push_back(v == 0 ? '.' : static_cast<char>('0' + v));
-  }
+  for (int i = 0; i < kCellCount; ++i) out.push_back(ValueToChar(cells_[i]));
   return out;
 }
 
-std::string SudokuGrid::ToPrettyString() const {
+template <int kBox>
+std::string BasicSudokuGrid<kBox>::ToPrettyString() const {
+  std::string border;
+  for (int b = 0; b < kBoxSize; ++b) {
+    border += '+';
+    border.append(2 * kBoxSize + 1, '-');
+  }
+  border += '+';
+
   std::ostringstream oss;
   for (int r = 0; r < kSize; ++r) {
-    if (r % 3 == 0) oss << "+-------+-------+-------+\n";
+    if (r % kBoxSize == 0) oss << border << '\n';
     for (int c = 0; c < kSize; ++c) {
-      if (c % 3 == 0) oss << "| ";
-      const int v = Get(r, c);
-      oss << (v == 0 ? '.' : static_cast<char>('0' + v)) << ' ';
+      if (c % kBoxSize == 0) oss << "| ";
+      oss << ValueToChar(Get(r, c)) << ' ';
     }
     oss << "|\n";
   }
-  oss << "+-------+-------+-------+";
+  oss << border;
   return oss.str();
 }
 
-bool IsGridValid(const SudokuGrid& grid, std::string* reason) {
-  std::array<int, 9> row_mask{};
-  std::array<int, 9> col_mask{};
-  std::array<int, 9> box_mask{};
+const UnitCellTable& UnitCells() {
+  static const UnitCellTable table = [] {
+    UnitCellTable t{};
+    for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+      const int r = SudokuGrid::RowOf(i);
+      const int c = SudokuGrid::ColOf(i);
+      const int in_box = (r % SudokuGrid::kBoxSize) * SudokuGrid::kBoxSize +
+                         c % SudokuGrid::kBoxSize;
+      t[r][c] = i;
+      t[SudokuGrid::kSize + c][r] = i;
+      t[2 * SudokuGrid::kSize + SudokuGrid::BoxOf(i)][in_box] = i;
+    }
+    return t;
+  }();
+  return table;
+}
+
+template <int kBox>
+bool IsGridValid(const BasicSudokuGrid<kBox>& grid, std::string* reason) {
+  using Grid = BasicSudokuGrid<kBox>;
+
+  // Маски поддерживаются инкрементально, так что корректное поле (частый
+  // случай) распознаётся без обхода клеток; подробный разбор нужен только
+  // для текста причины.
+  if (!grid.HasConflicts()) {
+    if (reason) *reason = "";
+    return true;
+  }
+
+  std::array<std::uint32_t, Grid::kSize> row_mask{};
+  std::array<std::uint32_t, Grid::kSize> col_mask{};
+  std::array<std::uint32_t, Grid::kSize> box_mask{};
   row_mask.fill(0);
   col_mask.fill(0);
   box_mask.fill(0);
 
-  for (int r = 0; r < SudokuGrid::kSize; ++r) {
-    for (int c = 0; c < SudokuGrid::kSize; ++c) {
+  for (int r = 0; r < Grid::kSize; ++r) {
+    for (int c = 0; c < Grid::kSize; ++c) {
       const int v = grid.Get(r, c);
-      if (v < 0 || v > 9) {
-        if (reason) *reason = "значение вне диапазона 0..9";
+      if (v < 0 || v > Grid::kSize) {
+        if (reason) {
+          *reason = "значение вне диапазона 0.." + std::to_string(Grid::kSize);
+        }
         return false;
       }
       if (v == 0) continue;
 
-      const int bit = 1 << v;
-      const int b = BoxIndex(r, c);
+      const std::uint32_t bit = 1u << v;
+      const int b = Grid::BoxIndex(r, c);
 
       if ((row_mask[r] & bit) != 0) {
         if (reason) *reason = "повтор в строке " + std::to_string(r + 1);
@@ -89,7 +207,10 @@ bool IsGridValid(const SudokuGrid& grid, std::string* reason) {
         return false;
       }
       if ((box_mask[b] & bit) != 0) {
-        if (reason) *reason = "повтор в блоке 3x3 #" + std::to_string(b + 1);
+        if (reason) {
+          *reason = "повтор в блоке " + std::to_string(kBox) + "x" +
+                    std::to_string(kBox) + " #" + std::to_string(b + 1);
+        }
         return false;
       }
 
@@ -103,4 +224,11 @@ bool IsGridValid(const SudokuGrid& grid, std::string* reason) {
   return true;
 }
 
+#define SUDOKU_INSTANTIATE_GRID(B)                                  \
+  template class BasicSudokuGrid<B>;                                \
+  template bool IsGridValid<B>(const BasicSudokuGrid<B>& grid,      \
+                               std::string* reason);
+SUDOKU_FOR_EACH_BOX_SIZE(SUDOKU_INSTANTIATE_GRID)
+#undef SUDOKU_INSTANTIATE_GRID
+
 }  // namespace sudoku
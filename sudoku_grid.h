@@ -2,30 +2,104 @@
 #define SUDOKU_SUDOKU_GRID_H_
 
 #include <array>
+#include <cstdint>
 #include <string>
+#include <type_traits>
 
 namespace sudoku {
 
-class SudokuGrid {
+// Поддерживаемые размеры блока: 2 (поле 4×4), 3 (9×9), 4 (16×16), 5 (25×25).
+// Шаблоны поля, решателя, генератора и ввода-вывода явно инстанцируются
+// для каждого из них в своих .cpp.
+#define SUDOKU_FOR_EACH_BOX_SIZE(X) X(2) X(3) X(4) X(5)
+
+// Символ значения клетки: '.' — пусто, '1'..'9', далее 'A' = 10 ... 'P' = 25.
+char ValueToChar(int value);
+// Обратное преобразование ('.' и '0' — пусто, буквы без учёта регистра);
+// -1, если символ не обозначает значение клетки.
+int CharToValue(char ch);
+
+// Поле N×N (N = kBox²): один байт на клетку плюс маски занятых цифр для
+// строк, столбцов и блоков (бит v установлен, если цифра v уже
+// присутствует). Маски обновляются на каждом Set/Clear, поэтому решателю и
+// проверке корректности не нужно пересчитывать их заново. Все размеры —
+// константы времени компиляции, так что циклы по полю 9×9 остаются такими
+// же, как в нешаблонной версии.
+template <int kBox>
+class BasicSudokuGrid {
  public:
-  static constexpr int kSize = 9;
+  static constexpr int kBoxSize = kBox;
+  static constexpr int kSize = kBox * kBox;
   static constexpr int kCellCount = kSize * kSize;
 
-  SudokuGrid();
+  // Биты 1..N: до 9×9 хватает 16 бит, для 16×16 и 25×25 нужно 32.
+  using Mask =
+      std::conditional_t<(kSize < 16), std::uint16_t, std::uint32_t>;
+  static constexpr Mask kAllDigits =
+      static_cast<Mask>((std::uint64_t{1} << (kSize + 1)) - 2);
+
+  static_assert(kBox >= 2 && kBox <= 5, "поддерживаются блоки от 2 до 5");
+
+  BasicSudokuGrid();
 
   int Get(int row, int col) const;
-  void Set(int row, int col, int value);  // value: 0..9
+  void Set(int row, int col, int value);  // value: 0..N
   void Clear(int row, int col);
 
+  // Доступ по индексу клетки (row * N + col) без проверки границ —
+  // для горячих циклов решателя и генератора.
+  int GetCell(int index) const { return cells_[index]; }
+  void SetCell(int index, int value);
+
+  Mask RowMask(int row) const { return row_mask_[row]; }
+  Mask ColMask(int col) const { return col_mask_[col]; }
+  Mask BoxMask(int box) const { return box_mask_[box]; }
+
+  // Цифры, которые можно поставить в клетку, не нарушив правил.
+  Mask CandidateMask(int index) const {
+    return static_cast<Mask>(~(row_mask_[RowOf(index)] |
+                               col_mask_[ColOf(index)] |
+                               box_mask_[BoxOf(index)]) &
+                             kAllDigits);
+  }
+
+  // true, если какая-то цифра повторяется в строке, столбце или блоке.
+  bool HasConflicts() const { return has_conflicts_; }
+
   bool IsComplete() const;
   std::string ToPrettyString() const;
   std::string ToCompactString() const;
 
+  static int RowOf(int index) { return index / kSize; }
+  static int ColOf(int index) { return index % kSize; }
+  static int BoxIndex(int row, int col) {
+    return (row / kBoxSize) * kBoxSize + col / kBoxSize;
+  }
+  static int BoxOf(int index) { return BoxIndex(RowOf(index), ColOf(index)); }
+
  private:
-  std::array<int, kCellCount> cells_;
+  // Полный пересчёт масок; нужен только пока в поле есть повторы
+  // (тогда по одной маске нельзя понять, осталась ли цифра после Clear).
+  void RebuildMasks();
+
+  std::array<std::uint8_t, kCellCount> cells_;
+  std::array<Mask, kSize> row_mask_;
+  std::array<Mask, kSize> col_mask_;
+  std::array<Mask, kSize> box_mask_;
+  bool has_conflicts_;
 };
 
-bool IsGridValid(const SudokuGrid& grid, std::string* reason);
+// Классическое поле 9×9 — основной тип во всём проекте.
+using SudokuGrid = BasicSudokuGrid<3>;
+
+// Индексы клеток 27 групп: 0..8 — строки, 9..17 — столбцы, 18..26 — блоки.
+constexpr int kUnitCount = 3 * SudokuGrid::kSize;
+using UnitCellTable =
+    std::array<std::array<int, SudokuGrid::kSize>, kUnitCount>;
+const UnitCellTable& UnitCells();
+
+template <int kBox>
+bool IsGridValid(const BasicSudokuGrid<kBox>& grid, std::string* reason);
 
 }  // namespace sudoku
 
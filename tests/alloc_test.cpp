@@ -0,0 +1,174 @@
+// Горячие пути решателей и генератора не выделяют память: счётчик
+// AllocationCount (alloc_counter.h) не должен меняться за вызов. Сборка и
+// запуск — см. tests/run_tests.sh; код возврата 0 — все проверки прошли.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "dlx_solver.h"
+#include "generator.h"
+#include "grid_enumerator.h"
+#include "propagation.h"
+#include "solver.h"
+#include "variants.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  if (ok) return;
+  std::cerr << "FAIL: " << what << "\n";
+  ++failures;
+}
+
+// Первый вызов fn — прогрев (статические таблицы строятся один раз),
+// второй не должен выделить ни байта.
+template <typename Fn>
+void CheckNoAllocations(const char* what, Fn fn) {
+  fn();
+  const std::uint64_t before = sudoku::AllocationCount();
+  fn();
+  const std::uint64_t allocs = sudoku::AllocationCount() - before;
+  if (allocs != 0) {
+    std::cerr << what << ": выделений " << allocs << "\n";
+  }
+  Check(allocs == 0, what);
+}
+
+sudoku::SudokuGrid Parse(const char* text) {
+  sudoku::SudokuGrid grid;
+  for (int i = 0; i < sudoku::SudokuGrid::kCellCount; ++i) {
+    grid.SetCell(i, text[i] == '.' ? 0 : text[i] - '0');
+  }
+  return grid;
+}
+
+const char kEasy[] =
+    "53..7....6..195....98....6.8...6...34..8.3..17...2...6"
+    ".6....28....419..5....8..79";
+const char kHard[] =
+    "8..........36......7..9.2...5...7.......457.....1...3..."
+    "1....68..85...1..9....4..";
+
+void TestSolvers() {
+  const sudoku::SudokuGrid easy = Parse(kEasy);
+  const sudoku::SudokuGrid hard = Parse(kHard);
+  for (const sudoku::SudokuGrid& puzzle : {easy, hard}) {
+    CheckNoAllocations("SolveIterative(mrv)", [&] {
+      sudoku::SudokuGrid work = puzzle;
+      sudoku::SolveIterative(&work, sudoku::CellOrder::kMinRemaining);
+    });
+    CheckNoAllocations("SolveWithPropagation", [&] {
+      sudoku::SudokuGrid work = puzzle;
+      sudoku::SolveWithPropagation(&work, nullptr);
+    });
+    CheckNoAllocations("SolveDlx", [&] {
+      sudoku::SudokuGrid work = puzzle;
+      sudoku::SolveDlx(&work);
+    });
+    CheckNoAllocations("CountSolutions",
+                       [&] { sudoku::CountSolutions(puzzle, 2); });
+  }
+  // Построчный перебор на трудной задаче идёт секундами.
+  CheckNoAllocations("SolveIterative(row)", [&] {
+    sudoku::SudokuGrid work = easy;
+    sudoku::SolveIterative(&work);
+  });
+}
+
+void TestGenerator() {
+  std::mt19937 rng(7);
+  sudoku::SplitMixRng split(7);
+  sudoku::SudokuGrid solved = sudoku::GenerateSolvedGrid(&rng);
+
+  CheckNoAllocations("GenerateSolvedGrid",
+                     [&] { solved = sudoku::GenerateSolvedGrid(&rng); });
+  CheckNoAllocations("GenerateRandomSolvedGrid(mt19937)", [&] {
+    solved = sudoku::GenerateRandomSolvedGrid(&rng);
+  });
+  CheckNoAllocations("GenerateRandomSolvedGrid(SplitMixRng)", [&] {
+    solved = sudoku::GenerateRandomSolvedGrid(&split);
+  });
+  CheckNoAllocations("CreatePuzzle(unique)", [&] {
+    sudoku::CreatePuzzle(solved, sudoku::SudokuGrid::kCellCount,
+                         sudoku::PuzzleCheck::kUnique, &rng, nullptr);
+  });
+  CheckNoAllocations("CreateMinimalPuzzle(rotational)", [&] {
+    sudoku::CreateMinimalPuzzle(solved, sudoku::ClueSymmetry::kRotational,
+                                &rng);
+  });
+
+  sudoku::SolvedGridEnumerator enumerator{sudoku::SudokuGrid()};
+  sudoku::SudokuGrid next;
+  CheckNoAllocations("SolvedGridEnumerator::Next",
+                     [&] { enumerator.Next(&next); });
+}
+
+void TestOtherBoardSizes() {
+  std::mt19937 rng(11);
+  const sudoku::BasicSudokuGrid<2> solved4 =
+      sudoku::GenerateSolvedGrid<2>(&rng);
+  CheckNoAllocations("CreatePuzzle<2>(unique)", [&] {
+    sudoku::CreatePuzzle(solved4, 16, sudoku::PuzzleCheck::kUnique, &rng,
+                         nullptr);
+  });
+
+  sudoku::BasicSudokuGrid<4> solved16;
+  CheckNoAllocations("GenerateSolvedGrid<4>",
+                     [&] { solved16 = sudoku::GenerateSolvedGrid<4>(&rng); });
+  const sudoku::BasicSudokuGrid<4> puzzle16 = sudoku::CreatePuzzle(
+      solved16, 100, sudoku::PuzzleCheck::kNone, &rng, nullptr);
+  CheckNoAllocations("SolveIterative<4>(mrv)", [&] {
+    sudoku::BasicSudokuGrid<4> work = puzzle16;
+    sudoku::SolveIterative(&work, sudoku::CellOrder::kMinRemaining);
+  });
+}
+
+void TestVariants() {
+  sudoku::ConstraintSet diagonal;
+  Check(diagonal.AddDiagonals(nullptr), "AddDiagonals");
+  CheckNoAllocations("SolveVariant(diagonal)", [&] {
+    sudoku::SudokuGrid work;
+    sudoku::SolveVariant(&work, diagonal, nullptr);
+  });
+
+  // Клетки killer по две в строке (последняя — одна) с суммами решения.
+  sudoku::SudokuGrid solved = Parse(kEasy);
+  sudoku::SolveWithPropagation(&solved, nullptr);
+  sudoku::ConstraintSet killer;
+  for (int r = 0; r < sudoku::SudokuGrid::kSize; ++r) {
+    for (int c = 0; c < sudoku::SudokuGrid::kSize; c += 2) {
+      const int i = r * sudoku::SudokuGrid::kSize + c;
+      std::vector<int> cells = {i};
+      int sum = solved.GetCell(i);
+      if (c + 1 < sudoku::SudokuGrid::kSize) {
+        cells.push_back(i + 1);
+        sum += solved.GetCell(i + 1);
+      }
+      Check(killer.AddCage(cells, sum, nullptr), "AddCage");
+    }
+  }
+  CheckNoAllocations("SolveVariant(killer)", [&] {
+    sudoku::SudokuGrid work;
+    sudoku::SolveVariant(&work, killer, nullptr);
+  });
+}
+
+}  // namespace
+
+int main() {
+  TestSolvers();
+  TestGenerator();
+  TestOtherBoardSizes();
+  TestVariants();
+  if (failures != 0) {
+    std::cerr << failures << " проверок не прошло\n";
+    return 1;
+  }
+  std::cout << "alloc_test: OK\n";
+  return 0;
+}
@@ -0,0 +1,81 @@
+// Проверки двоичного корпуса (corpus.h). Сборка и запуск — см.
+// tests/run_tests.sh; код возврата 0 — все проверки прошли.
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "corpus.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  if (ok) return;
+  std::cerr << "FAIL: " << what << "\n";
+  ++failures;
+}
+
+const char kPuzzle[] =
+    "53..7....6..195....98....6.8...6...34..8.3..17...2...6"
+    ".6....28....419..5....8..79";
+
+std::string TempPath(const char* name) {
+  const char* dir = std::getenv("TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/" + name;
+}
+
+void WriteText(const std::string& path, const std::string& text) {
+  std::ofstream out(path, std::ios::binary);
+  out << text;
+}
+
+// Ошибка разбора на середине: ни корпуса, ни временного файла не остаётся,
+// прежний корпус под тем же именем не меняется.
+void TestParseErrorLeavesNoOutput() {
+  const std::string text = TempPath("corpus_test.txt");
+  const std::string corpus = TempPath("corpus_test.sdkc");
+  std::remove(corpus.c_str());
+
+  WriteText(text, std::string(kPuzzle) + "\n" + kPuzzle + "\n12x\n");
+  std::uint64_t count = 0;
+  std::string error;
+  Check(!sudoku::ConvertTextToCorpus(text, corpus, &count, &error),
+        "ошибка разбора");
+  Check(!std::filesystem::exists(corpus), "корпус не создан");
+  Check(!std::filesystem::exists(corpus + ".tmp"),
+        "временный файл удалён");
+
+  WriteText(text, std::string(kPuzzle) + "\n");
+  Check(sudoku::ConvertTextToCorpus(text, corpus, &count, &error) &&
+            count == 1,
+        "корпус из одной задачи");
+  WriteText(text, "12x\n");
+  Check(!sudoku::ConvertTextToCorpus(text, corpus, &count, &error),
+        "ошибка разбора поверх корпуса");
+  sudoku::CorpusReader reader;
+  sudoku::SudokuGrid grid;
+  Check(reader.Open(corpus, &error) && reader.size() == 1 &&
+            reader.Get(0, &grid) && grid.ToCompactString() == kPuzzle,
+        "прежний корпус не тронут");
+  reader.Close();
+
+  std::remove(text.c_str());
+  std::remove(corpus.c_str());
+}
+
+}  // namespace
+
+int main() {
+  TestParseErrorLeavesNoOutput();
+  if (failures != 0) {
+    std::cerr << failures << " проверок не прошло\n";
+    return 1;
+  }
+  std::cout << "corpus_test: OK\n";
+  return 0;
+}
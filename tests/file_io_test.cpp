@@ -0,0 +1,93 @@
+// Проверки загрузки полей из файлов (file_io.h). Сборка и запуск — см.
+// tests/run_tests.sh; код возврата 0 — все проверки прошли.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "file_io.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  if (ok) return;
+  std::cerr << "FAIL: " << what << "\n";
+  ++failures;
+}
+
+const char kPuzzle[] =
+    "53..7....6..195....98....6.8...6...34..8.3..17...2...6"
+    ".6....28....419..5....8..79";
+
+std::string TempPath() {
+  const char* dir = std::getenv("TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/file_io_test.txt";
+}
+
+// Загружает поле из файла с текстом text.
+bool LoadText(const std::string& text, sudoku::SudokuGrid* grid) {
+  const std::string path = TempPath();
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+  }
+  std::string error;
+  const bool ok = sudoku::LoadGridFromFile(path, grid, &error);
+  std::remove(path.c_str());
+  return ok;
+}
+
+// Клетки kPuzzle через разделитель sep, с переводом строки после каждых
+// per_line клеток.
+std::string Layout(int per_line, const char* sep) {
+  std::string text;
+  for (int i = 0; i < sudoku::SudokuGrid::kCellCount; ++i) {
+    text += kPuzzle[i];
+    text += (i + 1) % per_line == 0 ? "\n" : sep;
+  }
+  return text;
+}
+
+void TestLayouts() {
+  const struct {
+    int per_line;
+    const char* sep;
+    const char* what;
+  } kCases[] = {
+      {81, "", "компактная строка"},
+      {9, " ", "9 строк по 9 клеток"},
+      {1, " ", "по клетке в строке"},
+      {27, " ", "3 строки по 27 клеток"},
+      {5, "\t", "строки по 5 клеток через табуляцию"},
+  };
+  for (const auto& c : kCases) {
+    sudoku::SudokuGrid grid;
+    Check(LoadText(Layout(c.per_line, c.sep), &grid) &&
+              grid.ToCompactString() == kPuzzle,
+          c.what);
+  }
+}
+
+void TestWrongCellCount() {
+  sudoku::SudokuGrid grid;
+  Check(!LoadText(std::string(kPuzzle, 80) + "\n", &grid), "80 клеток");
+  Check(!LoadText(std::string(kPuzzle) + " 1\n", &grid), "82 клетки");
+  Check(!LoadText(Layout(9, " ") + Layout(9, " "), &grid), "два поля");
+}
+
+}  // namespace
+
+int main() {
+  TestLayouts();
+  TestWrongCellCount();
+  if (failures != 0) {
+    std::cerr << failures << " проверок не прошло\n";
+    return 1;
+  }
+  std::cout << "file_io_test: OK\n";
+  return 0;
+}
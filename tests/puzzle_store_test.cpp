@@ -0,0 +1,86 @@
+// Проверки архива задач (puzzle_store.h). Сборка и запуск — см.
+// tests/run_tests.sh; код возврата 0 — все проверки прошли.
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "generator.h"
+#include "puzzle_store.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  if (ok) return;
+  std::cerr << "FAIL: " << what << "\n";
+  ++failures;
+}
+
+std::string TempPath() {
+  const char* dir = std::getenv("TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") +
+         "/puzzle_store_test.sdks";
+}
+
+// Обрыв дописывания: от новой записи в файле осталась часть байтов. Open
+// отрезает её, следующая запись встаёт на границу записи.
+void TestTruncatedLastRecord() {
+  const std::string path = TempPath();
+  std::remove(path.c_str());
+  std::mt19937 rng(3);
+  sudoku::SudokuGrid puzzles[3];
+  for (sudoku::SudokuGrid& p : puzzles) {
+    p = sudoku::CreatePuzzle(sudoku::GenerateSolvedGrid(&rng), 40,
+                             sudoku::PuzzleCheck::kNone, &rng, nullptr);
+  }
+
+  sudoku::PuzzleStore store;
+  std::string error;
+  Check(store.Open(path, false, &error), "создание архива");
+  Check(store.Insert(puzzles[0], nullptr) == sudoku::StoreInsert::kAdded,
+        "первая запись");
+  Check(store.Insert(puzzles[1], nullptr) == sudoku::StoreInsert::kAdded,
+        "вторая запись");
+  Check(store.Close(&error), "закрытие");
+
+  const auto full = std::filesystem::file_size(path);
+  {
+    std::ofstream tail(path, std::ios::binary | std::ios::app);
+    tail << "partial";
+  }
+  Check(store.Open(path, false, &error), "открытие с неполной записью");
+  Check(store.size() == 2, "целые записи на месте");
+  Check(std::filesystem::file_size(path) == full,
+        "неполная запись отрезана");
+  Check(store.Insert(puzzles[2], nullptr) == sudoku::StoreInsert::kAdded,
+        "запись после обрезки");
+  Check(store.Close(&error), "закрытие после обрезки");
+
+  Check(store.Open(path, false, &error), "повторное открытие");
+  std::size_t index = 0;
+  sudoku::SudokuGrid got;
+  Check(store.size() == 3 && store.Find(puzzles[2], &index) && index == 2 &&
+            store.Get(index, &got, nullptr) &&
+            got.ToCompactString() == puzzles[2].ToCompactString(),
+        "дописанная запись читается");
+  store.Close(nullptr);
+  std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+  TestTruncatedLastRecord();
+  if (failures != 0) {
+    std::cerr << failures << " проверок не прошло\n";
+    return 1;
+  }
+  std::cout << "puzzle_store_test: OK\n";
+  return 0;
+}
@@ -0,0 +1,16 @@
+#!/bin/sh
+# Собирает и запускает все tests/*_test.cpp; запуск из корня проекта:
+#   sh tests/run_tests.sh
+# Каждый тест — отдельная программа со всеми модулями, кроме main.cpp.
+set -e
+out=${TMPDIR:-/tmp}/sudoku_tests
+mkdir -p "$out"
+sources=$(ls *.cpp | grep -v '^main\.cpp$')
+status=0
+for test in tests/*_test.cpp; do
+  name=$(basename "$test" .cpp)
+  g++ -std=c++17 -Wall -Wextra -Wpedantic -O2 -pthread -I. "$test" $sources \
+      -o "$out/$name"
+  "$out/$name" || status=1
+done
+exit $status
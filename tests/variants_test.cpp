@@ -0,0 +1,108 @@
+// Регрессионные проверки вариантов судоку (variants.h). Сборка и запуск —
+// см. tests/run_tests.sh; код возврата 0 — все проверки прошли.
+
+#include <iostream>
+#include <string>
+
+#include "solver.h"
+#include "variants.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+  if (ok) return;
+  std::cerr << "FAIL: " << what << "\n";
+  ++failures;
+}
+
+void TestCageOfCluesWithWrongSum() {
+  sudoku::ConstraintSet set;
+  Check(set.AddCage({0, 1}, 5, nullptr), "клетка {0,1} с суммой 5");
+
+  sudoku::SudokuGrid grid;
+  grid.SetCell(0, 1);
+  grid.SetCell(1, 2);
+  sudoku::SudokuGrid work = grid;
+  Check(!sudoku::SolveVariant(&work, set, nullptr),
+        "подсказки 1+2 в клетке с суммой 5: решения нет");
+  Check(work.ToCompactString() == grid.ToCompactString(),
+        "при неудаче поле остаётся исходным");
+  Check(sudoku::CountVariantSolutions(grid, set, 2) == 0,
+        "подсказки 1+2 в клетке с суммой 5: 0 решений");
+}
+
+void TestCageOfCluesWithRightSum() {
+  sudoku::ConstraintSet set;
+  Check(set.AddCage({0, 1}, 3, nullptr), "клетка {0,1} с суммой 3");
+
+  sudoku::SudokuGrid grid;
+  grid.SetCell(0, 1);
+  grid.SetCell(1, 2);
+  Check(sudoku::SolveVariant(&grid, set, nullptr),
+        "подсказки 1+2 в клетке с суммой 3 решаются");
+  Check(sudoku::IsVariantGridValid(grid, set, nullptr),
+        "решение проходит IsVariantGridValid");
+}
+
+void TestCageClosedBySearch() {
+  sudoku::ConstraintSet set;
+  Check(set.AddCage({0, 1}, 5, nullptr), "клетка {0,1} с суммой 5");
+
+  sudoku::SudokuGrid grid;
+  grid.SetCell(0, 1);
+  Check(sudoku::SolveVariant(&grid, set, nullptr),
+        "подсказка 1 в клетке с суммой 5 решается");
+  Check(grid.GetCell(1) == 4, "последняя клетка добирает сумму: 4");
+  Check(sudoku::IsVariantGridValid(grid, set, nullptr),
+        "решение проходит IsVariantGridValid");
+}
+
+// Больше 256 групп: номера групп не должны переполняться. Одноклеточные
+// группы ничего не ограничивают, поэтому ответы — как у классики.
+void TestManyUnits() {
+  sudoku::ConstraintSet set;
+  bool added = true;
+  for (int copy = 0; copy < 4; ++copy) {
+    for (int i = 0; i < sudoku::SudokuGrid::kCellCount; ++i) {
+      added = set.AddUnit({i}, nullptr) && added;
+    }
+  }
+  Check(added && set.unit_count() == 27 + 4 * 81, "351 группа в наборе");
+
+  // Решённое поле без четырёх клеток-«прямоугольника» (цифры в нём можно
+  // поменять местами): ровно 2 решения.
+  sudoku::SudokuGrid grid;
+  const char kSolved[] =
+      "534678912672195348198342567859761423426853791713924856961537284"
+      "287419635345286179";
+  for (int i = 0; i < sudoku::SudokuGrid::kCellCount; ++i) {
+    grid.SetCell(i, kSolved[i] - '0');
+  }
+  for (int i : {3, 4, 30, 31}) grid.SetCell(i, 0);
+  Check(sudoku::CountSolutions(grid, 3) == 2, "классических решений 2");
+  Check(sudoku::IsVariantGridValid(grid, set, nullptr),
+        "задача проходит IsVariantGridValid");
+  Check(sudoku::CountVariantSolutions(grid, set, 3) == 2,
+        "с 351 группой решений тоже 2");
+  sudoku::SudokuGrid work = grid;
+  Check(sudoku::SolveVariant(&work, set, nullptr) &&
+            sudoku::IsVariantGridValid(work, set, nullptr) && work.IsComplete(),
+        "SolveVariant решает задачу");
+}
+
+}  // namespace
+
+int main() {
+  TestCageOfCluesWithWrongSum();
+  TestCageOfCluesWithRightSum();
+  TestCageClosedBySearch();
+  TestManyUnits();
+  if (failures != 0) {
+    std::cerr << failures << " проверок не прошло\n";
+    return 1;
+  }
+  std::cout << "variants_test: OK\n";
+  return 0;
+}
@@ -0,0 +1,403 @@
+#include "variants.h"
+
+#include <algorithm>
+
+#include "bits.h"
+#include "propagation.h"
+#include "solver_search.h"
+
+namespace sudoku {
+namespace {
+
+constexpr int kMaxSum = 45;  // 1 + 2 + ... + 9.
+
+// Наборы различных цифр по числу цифр k и сумме s (маски с битами 1..9):
+// по ним для клетки killer находятся цифры, которые ещё могут войти в сумму.
+// Все 511 наборов лежат подряд, упорядоченные по (k, s); наборы для (k, s) —
+// masks[first[k][s]] .. masks[first[k][s + 1]] без последнего. Таблица
+// фиксированного размера — без выделений памяти.
+struct CageCombos {
+  static constexpr int kSetCount = (1 << SudokuGrid::kSize) - 1;
+  std::array<std::uint16_t, kSetCount> masks{};
+  std::array<std::array<std::uint16_t, kMaxSum + 2>, SudokuGrid::kSize + 1>
+      first{};
+};
+
+const CageCombos& Combos() {
+  static const CageCombos combos = [] {
+    CageCombos c;
+    int n = 0;
+    for (int k = 0; k <= SudokuGrid::kSize; ++k) {
+      for (int sum = 0; sum <= kMaxSum + 1; ++sum) {
+        c.first[k][sum] = static_cast<std::uint16_t>(n);
+        if (sum > kMaxSum) continue;
+        for (unsigned m = 1; m < (1u << SudokuGrid::kSize); ++m) {
+          const unsigned digits = m << 1;
+          if (PopCount(digits) != k) continue;
+          int s = 0;
+          for (unsigned rest = digits; rest != 0; rest &= rest - 1) {
+            s += LowestBit(rest);
+          }
+          if (s == sum) c.masks[n++] = static_cast<std::uint16_t>(digits);
+        }
+      }
+    }
+    return c;
+  }();
+  return combos;
+}
+
+// Цифры, допустимые в пустой клетке группы с суммой: входят хотя бы в один
+// набор из empty различных ещё не занятых цифр с суммой sum_left.
+unsigned CageAllowed(unsigned used, int empty, int sum_left) {
+  if (empty <= 0 || sum_left <= 0 || sum_left > kMaxSum) return 0;
+  const CageCombos& combos = Combos();
+  unsigned allowed = 0;
+  for (int i = combos.first[empty][sum_left];
+       i < combos.first[empty][sum_left + 1]; ++i) {
+    if ((combos.masks[i] & used) == 0) allowed |= combos.masks[i];
+  }
+  return allowed;
+}
+
+const char* UnitKindName(UnitKind kind) {
+  switch (kind) {
+    case UnitKind::kRow:
+      return "в строке";
+    case UnitKind::kColumn:
+      return "в столбце";
+    case UnitKind::kBox:
+      return "в блоке 3x3";
+    case UnitKind::kRegion:
+      return "в области";
+    case UnitKind::kDiagonal:
+      return "на диагонали";
+    case UnitKind::kExtra:
+      return "в группе";
+    case UnitKind::kCage:
+      return "в клетке killer";
+  }
+  return "в группе";
+}
+
+// Номер группы среди групп того же вида, с 1.
+int KindOrdinal(const ConstraintSet& set, int index) {
+  int ordinal = 0;
+  for (int u = 0; u <= index; ++u) {
+    if (set.unit(u).kind == set.unit(index).kind) ++ordinal;
+  }
+  return ordinal;
+}
+
+// Состояние перебора: маски занятых цифр, остаток суммы и число пустых
+// клеток по каждой группе набора, списки групп по клеткам. Интерфейс — как
+// у SudokuGrid (GetCell, CandidateMask, SetCell), поэтому перебор — тот же
+// SearchMinRemaining из solver_search.h. Все массивы фиксированного размера:
+// решение не выделяет память.
+class VariantSearch {
+ public:
+  static constexpr int kCellCount = SudokuGrid::kCellCount;
+  static constexpr int kSize = SudokuGrid::kSize;
+  using Mask = std::uint16_t;
+
+  explicit VariantSearch(const ConstraintSet& set);
+
+  // false — подсказки уже противоречат набору (в том числе клетка killer
+  // из одних подсказок с неверной суммой).
+  bool Load(const SudokuGrid& grid);
+  void Store(SudokuGrid* grid) const;
+
+  int GetCell(int cell) const { return values_[cell]; }
+  unsigned CandidateMask(int cell) const;
+  void SetCell(int cell, int value) {
+    if (values_[cell] != 0) Remove(cell);
+    if (value != 0) Place(cell, value);
+  }
+
+ private:
+  void Place(int cell, int value);
+  void Remove(int cell);
+  // Заполненная клетка killer с неверной суммой: учитывается в bad_cages_.
+  bool IsBadCage(int unit) const {
+    return set_.unit(unit).sum != 0 && empty_left_[unit] == 0 &&
+           sum_left_[unit] != 0;
+  }
+
+  const ConstraintSet& set_;
+  std::array<std::uint8_t, SudokuGrid::kCellCount> values_{};
+  // Номера групп клетки: групп до kMaxUnits (648), байта не хватает.
+  std::array<std::array<std::uint16_t, ConstraintSet::kMaxUnitsPerCell>,
+             SudokuGrid::kCellCount>
+      cell_units_{};
+  std::array<std::uint8_t, SudokuGrid::kCellCount> cell_unit_count_{};
+  std::array<std::uint16_t, ConstraintSet::kMaxUnits> used_{};
+  std::array<int, ConstraintSet::kMaxUnits> sum_left_{};
+  std::array<int, ConstraintSet::kMaxUnits> empty_left_{};
+  int bad_cages_ = 0;
+};
+
+VariantSearch::VariantSearch(const ConstraintSet& set) : set_(set) {
+  for (int u = 0; u < set.unit_count(); ++u) {
+    const ConstraintUnit& unit = set.unit(u);
+    sum_left_[u] = unit.sum;
+    empty_left_[u] = unit.size;
+    for (int k = 0; k < unit.size; ++k) {
+      const int cell = unit.cells[k];
+      cell_units_[cell][cell_unit_count_[cell]++] =
+          static_cast<std::uint16_t>(u);
+    }
+  }
+}
+
+bool VariantSearch::Load(const SudokuGrid& grid) {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    const int v = grid.GetCell(i);
+    if (v == 0) continue;
+    for (int k = 0; k < cell_unit_count_[i]; ++k) {
+      const int u = cell_units_[i][k];
+      if ((used_[u] & (1u << v)) != 0) return false;
+      if (set_.unit(u).sum != 0 && sum_left_[u] < v) return false;
+    }
+    Place(i, v);
+  }
+  return bad_cages_ == 0;
+}
+
+// Для последней пустой клетки группы с суммой CageAllowed оставляет только
+// цифру sum_left, поэтому перебор сам не закрывает клетку killer с неверной
+// суммой; bad_cages_ > 0 (так могут лечь только подсказки) — тупик.
+unsigned VariantSearch::CandidateMask(int cell) const {
+  if (bad_cages_ != 0) return 0;
+  unsigned used = 0;
+  for (int k = 0; k < cell_unit_count_[cell]; ++k) {
+    used |= used_[cell_units_[cell][k]];
+  }
+  unsigned allowed = ~used & SudokuGrid::kAllDigits;
+  for (int k = 0; k < cell_unit_count_[cell] && allowed != 0; ++k) {
+    const int u = cell_units_[cell][k];
+    if (set_.unit(u).sum == 0) continue;
+    allowed &= CageAllowed(used_[u], empty_left_[u], sum_left_[u]);
+  }
+  return allowed;
+}
+
+void VariantSearch::Place(int cell, int value) {
+  values_[cell] = static_cast<std::uint8_t>(value);
+  for (int k = 0; k < cell_unit_count_[cell]; ++k) {
+    const int u = cell_units_[cell][k];
+    used_[u] = static_cast<std::uint16_t>(used_[u] | (1u << value));
+    sum_left_[u] -= value;
+    --empty_left_[u];
+    if (IsBadCage(u)) ++bad_cages_;
+  }
+}
+
+void VariantSearch::Remove(int cell) {
+  const int value = values_[cell];
+  values_[cell] = 0;
+  for (int k = 0; k < cell_unit_count_[cell]; ++k) {
+    const int u = cell_units_[cell][k];
+    if (IsBadCage(u)) --bad_cages_;
+    used_[u] = static_cast<std::uint16_t>(used_[u] & ~(1u << value));
+    sum_left_[u] += value;
+    ++empty_left_[u];
+  }
+}
+
+void VariantSearch::Store(SudokuGrid* grid) const {
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    grid->SetCell(i, values_[i]);
+  }
+}
+
+}  // namespace
+
+ConstraintSet::ConstraintSet() {
+  const UnitCellTable& table = UnitCells();
+  for (int u = 0; u < kUnitCount; ++u) {
+    ConstraintUnit unit;
+    unit.kind = u < SudokuGrid::kSize       ? UnitKind::kRow
+                : u < 2 * SudokuGrid::kSize ? UnitKind::kColumn
+                                            : UnitKind::kBox;
+    unit.size = SudokuGrid::kSize;
+    for (int k = 0; k < SudokuGrid::kSize; ++k) {
+      unit.cells[k] = static_cast<std::uint8_t>(table[u][k]);
+    }
+    units_.push_back(unit);
+  }
+  units_per_cell_.fill(3);
+}
+
+bool ConstraintSet::AddGroup(UnitKind kind, const std::vector<int>& cells,
+                             int sum, std::string* error) {
+  if (cells.empty() || cells.size() > SudokuGrid::kSize) {
+    if (error) *error = "в группе должно быть от 1 до 9 клеток";
+    return false;
+  }
+
+  ConstraintUnit unit;
+  unit.kind = kind;
+  unit.size = static_cast<int>(cells.size());
+  unit.sum = sum;
+  for (int k = 0; k < unit.size; ++k) {
+    const int cell = cells[k];
+    if (cell < 0 || cell >= SudokuGrid::kCellCount) {
+      if (error) *error = "номер клетки вне поля";
+      return false;
+    }
+    if (std::count(cells.begin(), cells.end(), cell) != 1) {
+      if (error) *error = "клетка указана в группе дважды";
+      return false;
+    }
+    if (units_per_cell_[cell] >= kMaxUnitsPerCell) {
+      if (error) *error = "через клетку проходит слишком много групп";
+      return false;
+    }
+    unit.cells[k] = static_cast<std::uint8_t>(cell);
+  }
+
+  for (int k = 0; k < unit.size; ++k) ++units_per_cell_[unit.cells[k]];
+  units_.push_back(unit);
+  classic_ = false;
+  if (error) *error = "";
+  return true;
+}
+
+bool ConstraintSet::AddDiagonals(std::string* error) {
+  if (diagonals_) {
+    if (error) *error = "диагонали уже добавлены";
+    return false;
+  }
+
+  std::vector<int> main_diagonal;
+  std::vector<int> anti_diagonal;
+  for (int k = 0; k < SudokuGrid::kSize; ++k) {
+    main_diagonal.push_back(k * SudokuGrid::kSize + k);
+    anti_diagonal.push_back(k * SudokuGrid::kSize + SudokuGrid::kSize - 1 - k);
+  }
+  if (!AddGroup(UnitKind::kDiagonal, main_diagonal, 0, error) ||
+      !AddGroup(UnitKind::kDiagonal, anti_diagonal, 0, error)) {
+    return false;
+  }
+  diagonals_ = true;
+  return true;
+}
+
+bool ConstraintSet::SetJigsawRegions(
+    const std::array<int, SudokuGrid::kCellCount>& region_of,
+    std::string* error) {
+  std::array<ConstraintUnit, SudokuGrid::kSize> regions{};
+  for (int i = 0; i < SudokuGrid::kCellCount; ++i) {
+    const int r = region_of[i];
+    if (r < 0 || r >= SudokuGrid::kSize) {
+      if (error) *error = "номер области вне диапазона 0..8";
+      return false;
+    }
+    if (regions[r].size == SudokuGrid::kSize) {
+      if (error) *error = "в области больше 9 клеток";
+      return false;
+    }
+    regions[r].cells[regions[r].size++] = static_cast<std::uint8_t>(i);
+  }
+
+  // Размеры областей в сумме дают 81, и ни одна не больше 9 — значит, все
+  // ровно по 9. Области заменяют блоки (группы 18..26).
+  for (int r = 0; r < SudokuGrid::kSize; ++r) {
+    regions[r].kind = UnitKind::kRegion;
+    units_[2 * SudokuGrid::kSize + r] = regions[r];
+  }
+  classic_ = false;
+  if (error) *error = "";
+  return true;
+}
+
+bool ConstraintSet::AddUnit(const std::vector<int>& cells,
+                            std::string* error) {
+  return AddGroup(UnitKind::kExtra, cells, 0, error);
+}
+
+bool ConstraintSet::AddCage(const std::vector<int>& cells, int sum,
+                            std::string* error) {
+  const int k = static_cast<int>(cells.size());
+  const int min_sum = k * (k + 1) / 2;
+  const int max_sum = k * (2 * SudokuGrid::kSize + 1 - k) / 2;
+  if (k > 0 && (sum < min_sum || sum > max_sum)) {
+    if (error) {
+      *error = "сумма " + std::to_string(sum) + " недостижима для " +
+               std::to_string(k) + " различных цифр";
+    }
+    return false;
+  }
+  return AddGroup(UnitKind::kCage, cells, sum, error);
+}
+
+bool IsVariantGridValid(const SudokuGrid& grid, const ConstraintSet& set,
+                        std::string* reason) {
+  if (set.IsClassic()) return IsGridValid(grid, reason);
+
+  for (int u = 0; u < set.unit_count(); ++u) {
+    const ConstraintUnit& unit = set.unit(u);
+    unsigned seen = 0;
+    int sum = 0;
+    int filled = 0;
+    for (int k = 0; k < unit.size; ++k) {
+      const int v = grid.GetCell(unit.cells[k]);
+      if (v == 0) continue;
+      if ((seen & (1u << v)) != 0) {
+        if (reason) {
+          *reason = std::string("повтор ") + UnitKindName(unit.kind) + " #" +
+                    std::to_string(KindOrdinal(set, u));
+        }
+        return false;
+      }
+      seen |= 1u << v;
+      sum += v;
+      ++filled;
+    }
+    if (unit.sum == 0) continue;
+    if (sum > unit.sum || (filled == unit.size && sum != unit.sum)) {
+      if (reason) {
+        *reason = "сумма в клетке killer #" +
+                  std::to_string(KindOrdinal(set, u)) + " должна быть " +
+                  std::to_string(unit.sum);
+      }
+      return false;
+    }
+  }
+
+  if (reason) *reason = "";
+  return true;
+}
+
+bool SolveVariant(SudokuGrid* grid, const ConstraintSet& set,
+                  SolveStats* stats) {
+  if (grid == nullptr) return false;
+  if (set.IsClassic()) return SolveWithPropagation(grid, nullptr, stats);
+
+  ScopedSolveTimer timer(stats);
+  SolveStats local;
+  SolveStats* s = stats != nullptr ? stats : &local;
+
+  VariantSearch search(set);
+  SearchBudget unlimited;
+  if (!search.Load(*grid) ||
+      SearchMinRemaining(&search, 1, s, &unlimited) != 1) {
+    return false;
+  }
+  search.Store(grid);
+  return true;
+}
+
+int CountVariantSolutions(const SudokuGrid& grid, const ConstraintSet& set,
+                          int limit) {
+  if (limit <= 0) return 0;
+  if (set.IsClassic()) return CountSolutions(grid, limit);
+
+  VariantSearch search(set);
+  if (!search.Load(grid)) return 0;
+  SolveStats stats;
+  SearchBudget unlimited;
+  return SearchMinRemaining(&search, limit, &stats, &unlimited);
+}
+
+}  // namespace sudoku
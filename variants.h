@@ -0,0 +1,91 @@
+#ifndef SUDOKU_VARIANTS_H_
+#define SUDOKU_VARIANTS_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "solver.h"
+#include "sudoku_grid.h"
+
+namespace sudoku {
+
+// Вид группы ограничений варианта.
+enum class UnitKind {
+  kRow,
+  kColumn,
+  kBox,       // Блок 3×3 классического судоку.
+  kRegion,    // Область jigsaw (заменяет блоки).
+  kDiagonal,  // Главная или побочная диагональ (X-судоку).
+  kExtra,     // Произвольная группа без повторов (windoku и т. п.).
+  kCage,      // Клетка killer: без повторов и с заданной суммой.
+};
+
+// Группа клеток поля 9×9, в которой цифры не повторяются; sum != 0 —
+// сумма цифр группы должна быть ровно sum.
+struct ConstraintUnit {
+  UnitKind kind = UnitKind::kExtra;
+  std::array<std::uint8_t, SudokuGrid::kSize> cells{};
+  int size = 0;
+  int sum = 0;
+};
+
+// Набор ограничений поля 9×9: строки, столбцы, блоки (или области jigsaw)
+// и дополнительные группы. По умолчанию — классическое судоку.
+class ConstraintSet {
+ public:
+  // Сколько групп может проходить через одну клетку.
+  static constexpr int kMaxUnitsPerCell = 8;
+  // Групп не больше, чем пар «группа — клетка»: в группе хотя бы одна клетка.
+  static constexpr int kMaxUnits = SudokuGrid::kCellCount * kMaxUnitsPerCell;
+
+  ConstraintSet();
+
+  // Обе диагонали без повторов (X-судоку).
+  bool AddDiagonals(std::string* error);
+  // Области jigsaw вместо блоков: region_of[i] — номер области (0..8)
+  // клетки i, в каждой области ровно 9 клеток.
+  bool SetJigsawRegions(
+      const std::array<int, SudokuGrid::kCellCount>& region_of,
+      std::string* error);
+  // Дополнительная группа без повторов (1..9 различных клеток).
+  bool AddUnit(const std::vector<int>& cells, std::string* error);
+  // Клетка killer: без повторов, сумма цифр — sum.
+  bool AddCage(const std::vector<int>& cells, int sum, std::string* error);
+
+  // true — только строки, столбцы и блоки: решать и проверять можно
+  // обычным кодом SudokuGrid.
+  bool IsClassic() const { return classic_; }
+
+  int unit_count() const { return static_cast<int>(units_.size()); }
+  const ConstraintUnit& unit(int index) const { return units_[index]; }
+
+ private:
+  bool AddGroup(UnitKind kind, const std::vector<int>& cells, int sum,
+                std::string* error);
+
+  std::vector<ConstraintUnit> units_;
+  std::array<int, SudokuGrid::kCellCount> units_per_cell_{};
+  bool classic_ = true;
+  bool diagonals_ = false;
+};
+
+// Корректность поля с учётом всех групп набора: повторы в группах,
+// превышение суммы клетки killer, неверная сумма заполненной клетки.
+bool IsVariantGridValid(const SudokuGrid& grid, const ConstraintSet& set,
+                        std::string* reason);
+
+// MRV-перебор по маскам всех групп набора. Для классического набора —
+// SolveWithPropagation, так что скорость обычного случая не меняется.
+// При неудаче поле остаётся исходным; stats может быть nullptr.
+bool SolveVariant(SudokuGrid* grid, const ConstraintSet& set,
+                  SolveStats* stats);
+
+// Число решений с отсечкой limit (как CountSolutions).
+int CountVariantSolutions(const SudokuGrid& grid, const ConstraintSet& set,
+                          int limit);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_VARIANTS_H_